@@ -0,0 +1,94 @@
+#include <Mokosh.hpp>
+
+// measures the dispatch of 100 commands: registered in the command registry,
+// and handled by 10 services comparing them one by one in command(), which
+// is how all commands were handled before the registry
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+volatile int hits = 0;
+
+// a service handling 10 commands in command()
+class Legacy : public MokoshService
+{
+public:
+    Legacy(int base)
+    {
+        for (int i = 0; i < 10; i++)
+            names[i] = String("old") + String(base + i);
+    }
+
+    virtual bool setup() override { return true; }
+    virtual void loop() override {}
+    virtual unsigned long getPollInterval() override { return MokoshService::POLL_NEVER; }
+
+    virtual bool command(String command, String param) override
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            if (command == names[i])
+            {
+                hits++;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    String names[10];
+};
+
+static void measure(const char *title, const char *prefix)
+{
+    // the names are prepared before, so only the dispatch is measured
+    String names[100];
+    for (int i = 0; i < 100; i++)
+        names[i] = String(prefix) + String(i);
+
+    hits = 0;
+    unsigned long start = micros();
+    for (int n = 0; n < 200; n++)
+    {
+        for (int i = 0; i < 100; i++)
+            mokosh._processCommand(names[i]);
+    }
+
+    printf("%-12s %.3f us per dispatch, %d handled\n", title, (micros() - start) / 20000.0, hits);
+}
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+
+    char keys[10][8];
+    for (int s = 0; s < 10; s++)
+    {
+        snprintf(keys[s], sizeof(keys[s]), "L%d", s);
+        mokosh.registerService(keys[s], std::make_shared<Legacy>(s * 10));
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "cmd%d", i);
+        mokosh.registerCommand(name, [](MokoshStringView param) { hits++; });
+    }
+
+    mokosh.begin();
+    unsigned long start = millis();
+    while (millis() - start < 1000)
+        mokosh.loop();
+
+    printf("commands %zu\n", mokosh.getCommands().size());
+    for (int r = 0; r < 3; r++)
+    {
+        measure("command()", "old");
+        measure("registered", "cmd");
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <Mokosh.hpp>
+#include <atomic>
+
+// runs a service on the executor, which on the host is a std::thread,
+// while the main loop changes the configuration, then measures round trips
+// of jobs executed on the worker and posted back; best built also with
+// -fsanitize=thread, which reports any unguarded access:
+//   ./build.sh bench_executor.cpp -O1 -g -fsanitize=thread
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+// a service looped by the worker, logging, publishing and using the
+// configuration every 50 iterations
+class Worker : public MokoshService
+{
+public:
+    std::atomic<long> loops{0};
+
+    virtual bool setup() override { return true; }
+    virtual bool isRunOnExecutor() override { return true; }
+    virtual void loop() override
+    {
+        long n = ++this->loops;
+        if (n % 50 == 0)
+        {
+            mokosh.config->set("counter", (int)n);
+            mlogI("Worker loop %ld", n);
+            mokosh.getMqttService()->publish("worker", "loop");
+        }
+
+        volatile int value = mokosh.config->get<int>("main", 0);
+        (void)value;
+    }
+};
+
+static const long JOBS = 200000;
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+
+    auto worker = std::make_shared<Worker>();
+    mokosh.registerService("WORKER", worker);
+    mokosh.setExecutor(true, 1);
+    mokosh.begin();
+
+    unsigned long start = millis();
+    int i = 0;
+    while (millis() - start < 500)
+    {
+        mokosh.loop();
+        mokosh.config->set("main", i++);
+        delay(1);
+    }
+
+    printf("worker loops %ld, counter %d\n", worker->loops.load(), mokosh.config->get<int>("counter", 0));
+
+    // every job is executed on the worker and posts one back, which is run
+    // by loop(); the rings are small, so both may be full at times
+    std::atomic<long> lost{0};
+    long executed = 0;
+    long returned = 0;
+
+    start = micros();
+    while (executed < JOBS || returned + lost < JOBS)
+    {
+        if (executed < JOBS && mokosh.execute([&]()
+                                              {
+                                                  if (!mokosh.post([&]() { returned++; }))
+                                                      lost++; }))
+            executed++;
+
+        mokosh.loop();
+    }
+    double time = (micros() - start) / 1000000.0;
+
+    mokosh.setExecutor(false);
+
+    printf("%ld round trips in %.3f s, %.0f per second, %ld posts lost\n", returned, time, returned / time, lost.load());
+    if (worker->loops == 0 || returned + lost != JOBS)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <MokoshFormat.hpp>
+#include <stdarg.h>
+
+// compares the output of MokoshFormat with vsnprintf of glibc for all the
+// supported conversions and 100k random floats, then measures both on
+// typical log messages
+static int failed = 0;
+
+static void check(const char *fmt, ...)
+{
+    char expected[512];
+    char actual[512];
+
+    va_list args;
+    va_list copy;
+    va_start(args, fmt);
+    va_copy(copy, args);
+
+    vsnprintf(expected, sizeof(expected), fmt, args);
+    MokoshBufferSink sink(actual, sizeof(actual));
+    size_t length = MokoshFormat::format(sink, fmt, copy);
+
+    va_end(copy);
+    va_end(args);
+
+    if (strcmp(expected, actual) != 0 || length != strlen(expected))
+    {
+        failed++;
+        printf("FAILED [%s]: '%s' instead of '%s'\n", fmt, actual, expected);
+    }
+}
+
+static const long CALLS = 1000000;
+
+// returns time in microseconds of formatting the message CALLS times
+static unsigned long measure(bool isOwn, const char *fmt, ...)
+{
+    char buffer[256];
+
+    va_list args;
+    va_start(args, fmt);
+
+    unsigned long start = micros();
+    for (long i = 0; i < CALLS; i++)
+    {
+        va_list copy;
+        va_copy(copy, args);
+
+        if (isOwn)
+        {
+            MokoshBufferSink sink(buffer, sizeof(buffer));
+            MokoshFormat::format(sink, fmt, copy);
+        }
+        else
+        {
+            vsnprintf(buffer, sizeof(buffer), fmt, copy);
+        }
+
+        va_end(copy);
+    }
+
+    unsigned long time = micros() - start;
+    va_end(args);
+
+    return time;
+}
+
+int main()
+{
+    check("plain");
+    check("%d %i %u", -5, 7, 3000000000u);
+    check("%5d|%-5d|%05d|%+d|% d", 42, 42, -42, 3, 3);
+    check("%ld %lu %lld %llu", -123456789L, 4000000000UL, -9000000000LL, 18000000000000000000ULL);
+    check("%x %X %08x %#x %o %#o", 255, 255, 0xbeef, 16, 8, 8);
+    check("%c%c", 'o', 'k');
+    check("%s|%10s|%-10s|%.2s", "abc", "abc", "abc", "abc");
+    check("%f %.2f %.0f %8.3f %-8.1f| %08.2f %+.1f", 3.14159, 2.005, 2.5, -1.5, 0.25, -3.14159, 1.0);
+    check("%f", 1234567.891);
+    check("%.3f", 0.0005);
+    check("%f", 1e30);
+    check("%zu %%", (size_t)5);
+    check("%*d|%-*d|%.*f|%.*s", 6, 1, 6, 2, 2, 1.2345, 3, "abcdef");
+    check("%.3d|%.0d|%5.3d", 7, 0, -7);
+    check("%p", (void *)0x1234);
+
+    // handed to snprintf
+    check("%e %g %.3e", 12345.678, 0.0001, 1e30);
+
+    // longer than a chunk
+    char text[400];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = 0;
+    check("[%s] end", text);
+
+    srand(1);
+    for (int i = 0; i < 100000; i++)
+    {
+        double value = (rand() % 2000000) / 1000.0 - 1000;
+        check("%.2f|%.1f|%.0f|%f|%.3f", value, value, value, value, value / 7);
+    }
+
+    printf("%d failed\n", failed);
+
+    const char *fmt = "MQTT broker set to %s port %d, %ld ms";
+    for (int r = 0; r < 3; r++)
+    {
+        unsigned long own = measure(true, fmt, "192.168.1.10", 1883, 12345L);
+        unsigned long libc = measure(false, fmt, "192.168.1.10", 1883, 12345L);
+        printf("%-8s MokoshFormat %.1f ns, vsnprintf %.1f ns\n", "strings", own * 1000.0 / CALLS, libc * 1000.0 / CALLS);
+
+        own = measure(true, "t=%.2f", 21.375);
+        libc = measure(false, "t=%.2f", 21.375);
+        printf("%-8s MokoshFormat %.1f ns, vsnprintf %.1f ns\n", "float", own * 1000.0 / CALLS, libc * 1000.0 / CALLS);
+    }
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,88 @@
+#include <Mokosh.hpp>
+
+// runs 10 ms timers for 10 s while a service keeps every iteration of
+// loop() busy for 3 ms, and blocks loop() once for 55 ms; the timer catching
+// up with every missed run must run exactly 1000 times, the other policies
+// drop the missed runs; prints the lateness and jitter histograms
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+// a service busy for 3 ms in every iteration, and once for 55 ms
+class Load : public MokoshService
+{
+public:
+    virtual bool setup() override { return true; }
+    virtual void loop() override
+    {
+        unsigned long time = 3;
+        if (!this->isBlocked && millis() - this->startTime > 5000)
+        {
+            time = 55;
+            this->isBlocked = true;
+        }
+
+        unsigned long start = micros();
+        while (micros() - start < time * 1000)
+        {
+        }
+    }
+
+    unsigned long startTime = 0;
+    bool isBlocked = false;
+};
+
+static void print(const char *title, MokoshTimer &timer)
+{
+    const MokoshTimerStats *stats = timer.getStats();
+    printf("%-16s %4u runs, %2u missed, max lateness %lu ms\n", title, stats->runCount, stats->missedCount, stats->maxLateness);
+
+    printf("  lateness");
+    for (int i = 0; i < MOKOSH_TIMER_HISTOGRAM_SIZE; i++)
+        printf(" %4u", stats->lateness[i]);
+
+    printf("\n  jitter  ");
+    for (int i = 0; i < MOKOSH_TIMER_HISTOGRAM_SIZE; i++)
+        printf(" %4u", stats->jitter[i]);
+
+    printf("\n");
+}
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+
+    auto load = std::make_shared<Load>();
+    mokosh.registerService("LOAD", load);
+    mokosh.begin();
+
+    // the timers start together, and run for 10 s, up to the 1000th run,
+    // which is late by less than 9 ms
+    load->startTime = millis();
+
+    MokoshTimer timers[3];
+    TimerCatchUpPolicy policies[3] = {TimerCatchUpPolicy::SKIP_MISSED, TimerCatchUpPolicy::RUN_MISSED_ONCE, TimerCatchUpPolicy::RUN_ALL_MISSED};
+    for (int i = 0; i < 3; i++)
+    {
+        timers[i] = mokosh.registerIntervalFunction([]() {}, 10);
+        timers[i].setCatchUpPolicy(policies[i]);
+    }
+
+    while (millis() - load->startTime < 10009)
+        mokosh.loop();
+
+    print("SKIP_MISSED", timers[0]);
+    print("RUN_MISSED_ONCE", timers[1]);
+    print("RUN_ALL_MISSED", timers[2]);
+
+    const MokoshTimerStats *stats = timers[2].getStats();
+    if (stats->runCount != 1000 || timers[0].getStats()->missedCount == 0)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
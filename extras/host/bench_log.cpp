@@ -0,0 +1,72 @@
+#include <Mokosh.hpp>
+
+// measures the cost of an mlogD call below the level of all the loggers,
+// which returns before formatting, against the same call formatted and then
+// dropped by the logger, which is what every suppressed call cost before;
+// built with -DMOKOSH_LOG_MIN_LEVEL=2 the mlogD calls are removed at compile
+// time and both cases show the cost of an empty loop
+Mokosh mokosh("Mokosh", "1.0.0", false, false);
+
+// a logger counting the messages it gets, and dropping all of them below
+// its own threshold, as the loggers did before the levels were cached
+class Discard : public MokoshLogger
+{
+public:
+    virtual bool setup() override { return true; }
+    virtual void loop() override {}
+    virtual void ticker_step() override {}
+    virtual void ticker_finish(bool success) override {}
+
+    virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) override
+    {
+        if (level < LogLevel::WARNING)
+            return;
+
+        received++;
+    }
+
+    unsigned long received = 0;
+};
+
+static const long CALLS = 2000000;
+
+static void measure(const char *title)
+{
+    const char *topic = "Mokosh_ABCDEF/debug/heartbeat";
+    const char *payload = "{\"uptime\": 12345, \"freeheap\": 40000}";
+
+    unsigned long start = micros();
+    for (long i = 0; i < CALLS; i++)
+        mlogD("Publishing %s to %s, %ld", payload, topic, i);
+
+    printf("%-28s %.1f ns per call\n", title, (micros() - start) * 1000.0 / CALLS);
+}
+
+int main()
+{
+    auto logger = std::make_shared<Discard>();
+    mokosh.registerLogger(logger);
+
+    // the same arguments are not repeated, but the limiter would still
+    // skip the formatting of the repeated message
+    mokosh.setLogRateLimit(0);
+
+    for (int r = 0; r < 3; r++)
+    {
+        mokosh.setLogLevel(LogLevel::WARNING);
+        measure("suppressed");
+
+        // the cache lets the message through, the logger drops it
+        logger->setLevel(LogLevel::DEBUG);
+        Mokosh::updateLogLevelCache();
+        measure("formatted and dropped");
+    }
+
+    if (logger->received > 0)
+    {
+        printf("FAILED, %lu messages logged\n", logger->received);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <Mokosh.hpp>
+
+// measures the time of Mokosh::loop() with 20 registered services: 16
+// dummies (4 run in every iteration, 8 every 50 ms, 4 never) and the
+// built-in ones
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+// a service with a bit of work in loop() and a given poll interval
+class Dummy : public MokoshService
+{
+public:
+    Dummy(unsigned long interval) : interval(interval) {}
+    virtual bool setup() override { return true; }
+    virtual void loop() override
+    {
+        calls++;
+        for (int i = 0; i < 20; i++)
+            counter = counter * 31 + i;
+    }
+    virtual unsigned long getPollInterval() override { return interval; }
+    unsigned long interval;
+    volatile unsigned long counter = 0;
+    unsigned long calls = 0;
+};
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+
+    char keys[16][8];
+    for (int i = 0; i < 16; i++)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "D%d", i);
+        // 4 in every iteration, 8 every 50 ms, 4 never
+        unsigned long interval = i < 4 ? 0 : (i < 12 ? 50 : ULONG_MAX);
+        mokosh.registerService(keys[i], std::make_shared<Dummy>(interval));
+    }
+
+    std::vector<std::shared_ptr<Dummy>> dummies;
+    for (int i = 0; i < 16; i++) dummies.push_back(mokosh.getRegisteredService<Dummy>(keys[i]));
+    mokosh.begin();
+    unsigned long t = millis();
+    while (millis() - t < 500)
+        mokosh.loop();
+
+    printf("services %zu\n", mokosh.getRegisteredServices().size());
+    for (int r = 0; r < 3; r++)
+    {
+        unsigned long start = micros();
+        for (int i = 0; i < 200000; i++)
+            mokosh.loop();
+        printf("loop %.3f us\n", (micros() - start) / 200000.0);
+    }
+    unsigned long total = millis() - t;
+    printf("elapsed %lu ms, calls D0 %lu D4 %lu D12 %lu\n", total, dummies[0]->calls, dummies[4]->calls, dummies[12]->calls);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <Mokosh.hpp>
+
+// measures the longest iteration of loop() while Wi-Fi reconnects for 3 s,
+// and how many times a 10 ms timer runs meanwhile; before the reconnection
+// was a task, loop() was blocked for the whole time of reconnecting
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+
+    mokosh.begin();
+
+    int ticks = 0;
+    mokosh.registerIntervalFunction([&]()
+                                    { ticks++; },
+                                    10);
+
+    unsigned long start = millis();
+    while (millis() - start < 1000)
+        mokosh.loop();
+
+    if (!WiFi.isConnected())
+    {
+        printf("Wi-Fi is not connected\n");
+        return 1;
+    }
+
+    // the connection is lost and comes back after 3 s
+    WiFi.st = WL_DISCONNECTED;
+    WiFi.began = false;
+    WiFi.failUntil = millis() + 3000;
+
+    ticks = 0;
+    unsigned long maxLatency = 0;
+    unsigned long reconnected = 0;
+    start = millis();
+    while (millis() - start < 5000)
+    {
+        unsigned long before = millis();
+        mokosh.loop();
+        maxLatency = std::max(maxLatency, millis() - before);
+
+        if (reconnected == 0 && WiFi.isConnected())
+            reconnected = millis() - start;
+
+        delay(1);
+    }
+
+    printf("reconnected after %lu ms, longest loop() %lu ms, %d timer runs in 5 s\n", reconnected, maxLatency, ticks);
+    if (reconnected == 0 || maxLatency > 50 || ticks < 400)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <Mokosh.hpp>
+#include <MokoshStatic.hpp>
+
+// measures the time of loop() with Wi-Fi, MQTT and 16 services, built as
+// the dynamic Mokosh or, with -DSTATIC, as MokoshStatic:
+//   ./build.sh bench_static.cpp -O2 && build/bench_static
+//   ./build.sh bench_static.cpp -O2 -DSTATIC && build/bench_static
+//
+// BROKEN_ORDER, BROKEN_MISSING and BROKEN_DUPLICATE add a MokoshStatic with
+// an error, which has to be reported by static_assert during compilation
+
+static constexpr const char *dummyKeys[] = {"D0", "D1", "D2", "D3", "D4", "D5", "D6", "D7", "D8", "D9", "D10", "D11", "D12", "D13", "D14", "D15"};
+static constexpr const char *dummyDependencies[] = {"MQTT", nullptr};
+
+// 8 services run in every iteration, 8 every 50 ms
+template <int N>
+class Dummy : public MokoshService
+{
+public:
+    virtual bool setup() override { return true; }
+    virtual void loop() override
+    {
+        calls++;
+        for (int i = 0; i < 20; i++)
+            counter = counter * 31 + i;
+    }
+    virtual unsigned long getPollInterval() override { return N < 8 ? 0 : 50; }
+    virtual std::vector<const char *> getDependencies() override { return {MokoshService::DEPENDENCY_MQTT}; }
+    static constexpr const char *STATIC_KEY = dummyKeys[N];
+    static constexpr const char *const *STATIC_DEPENDENCIES = dummyDependencies;
+    volatile unsigned long counter = 0;
+    unsigned long calls = 0;
+};
+
+#ifdef STATIC
+MokoshStatic<MokoshWiFiService, PubSubClientService,
+             Dummy<0>, Dummy<1>, Dummy<2>, Dummy<3>, Dummy<4>, Dummy<5>, Dummy<6>, Dummy<7>,
+             Dummy<8>, Dummy<9>, Dummy<10>, Dummy<11>, Dummy<12>, Dummy<13>, Dummy<14>, Dummy<15>>
+    mokosh("Mokosh", "1.0.0", false);
+#else
+Mokosh mokosh("Mokosh", "1.0.0", false);
+template <int... N>
+void registerDummies(std::integer_sequence<int, N...>)
+{
+    (mokosh.registerService(dummyKeys[N], std::make_shared<Dummy<N>>()), ...);
+}
+#endif
+
+// MQTT before the network it depends on
+#ifdef BROKEN_ORDER
+MokoshStatic<PubSubClientService, MokoshWiFiService> broken("x");
+#endif
+
+// MQTT is not there at all
+#ifdef BROKEN_MISSING
+MokoshStatic<MokoshWiFiService, Dummy<0>> broken("x");
+#endif
+
+// the same key twice
+#ifdef BROKEN_DUPLICATE
+MokoshStatic<MokoshWiFiService, MokoshWiFiService> broken("x");
+#endif
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+#ifndef STATIC
+    registerDummies(std::make_integer_sequence<int, 16>());
+#endif
+    mokosh.begin();
+    unsigned long t = millis();
+    while (millis() - t < 1000)
+        mokosh.loop();
+
+    bool isConnected = mokosh.getMqttService() != nullptr && mokosh.getMqttService()->isConnected();
+    printf("services %zu, MQTT %s\n", mokosh.getRegisteredServices().size(), isConnected ? "connected" : "not connected");
+    for (int r = 0; r < 3; r++)
+    {
+        unsigned long start = micros();
+        for (int i = 0; i < 200000; i++)
+            mokosh.loop();
+        printf("loop %.3f us\n", (micros() - start) / 200000.0);
+    }
+#ifdef STATIC
+    printf("calls D0 %lu D8 %lu after %lu ms\n", mokosh.get<Dummy<0>>().calls, mokosh.get<Dummy<8>>().calls, millis() - t);
+#endif
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <MokoshScheduler.hpp>
+#include <memory>
+
+// measures an idle update of 1, 50 and 500 timers, none of them due: the
+// scheduler against a vector of TickTwo objects updated one by one, which is
+// how Mokosh::loop() handled the timers before
+//
+// the part of TickTwo 4.4.0 used by Mokosh, with millis() resolution, and
+// update() not inlined, as it is compiled in the library
+class TickTwo
+{
+public:
+    TickTwo(fptr callback, uint32_t timer, uint32_t repeat = 0) : callback(callback), timer(timer), repeat(repeat) {}
+
+    void start()
+    {
+        this->lastTime = millis();
+        this->enabled = true;
+        this->counts = 0;
+    }
+
+    __attribute__((noinline)) void update()
+    {
+        if (this->tick())
+            this->callback();
+    }
+
+private:
+    bool tick()
+    {
+        if (!this->enabled)
+            return false;
+
+        uint32_t currentTime = millis();
+        if ((currentTime - this->lastTime) >= this->timer)
+        {
+            this->lastTime = currentTime;
+            if (this->repeat - this->counts == 1 && this->counts != 0xFFFFFFFF)
+                this->enabled = false;
+
+            this->counts++;
+            return true;
+        }
+
+        return false;
+    }
+
+    fptr callback;
+    uint32_t timer;
+    uint32_t repeat;
+    uint32_t counts = 0;
+    uint32_t lastTime = 0;
+    bool enabled = false;
+};
+
+static const long UPDATES = 200000;
+static volatile int runs = 0;
+
+static void measure(int count)
+{
+    std::vector<std::shared_ptr<TickTwo>> tickers;
+    MokoshScheduler scheduler;
+
+    // long intervals, so nothing is due during the measurement
+    for (int i = 0; i < count; i++)
+    {
+        unsigned long interval = 60000 + i * 100;
+
+        auto ticker = std::make_shared<TickTwo>([]()
+                                                { runs++; }, interval);
+        ticker->start();
+        tickers.push_back(ticker);
+
+        scheduler.add([]()
+                      { runs++; }, interval);
+    }
+
+    unsigned long start = micros();
+    for (long n = 0; n < UPDATES; n++)
+    {
+        for (auto &ticker : tickers)
+            ticker->update();
+    }
+    double tickTwo = (micros() - start) * 1000.0 / UPDATES;
+
+    start = micros();
+    for (long n = 0; n < UPDATES; n++)
+        scheduler.update();
+    double own = (micros() - start) * 1000.0 / UPDATES;
+
+    printf("%3d timers  TickTwo %8.1f ns, MokoshScheduler %5.1f ns per update\n", count, tickTwo, own);
+}
+
+int main()
+{
+    for (int r = 0; r < 3; r++)
+    {
+        measure(1);
+        measure(50);
+        measure(500);
+    }
+
+    return runs > 0 ? 1 : 0;
+}
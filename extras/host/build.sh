@@ -0,0 +1,11 @@
+#!/bin/sh
+# builds a host program against the library, with the Arduino core and the
+# libraries replaced by the stubs, as for ESP8266; e.g.
+#   ./build.sh bench_poll.cpp -O2 && build/bench_poll
+set -e
+cd "$(dirname "$0")"
+SOURCE=$1
+shift
+mkdir -p build
+g++ -std=gnu++17 -DESP8266 -Wall -Wno-unused-variable -Wno-unused-function -I stubs -I ../../src "$@" \
+    ../../src/*.cpp stubs/stubs.cpp "$SOURCE" -o "build/${SOURCE%.cpp}" -lpthread
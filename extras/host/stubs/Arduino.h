@@ -0,0 +1,137 @@
+#pragma once
+
+// host stand-ins for the Arduino core, only what Mokosh and the programs
+// in extras/host use; String wraps std::string, time is the steady clock,
+// or a fake one
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstdarg>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <memory>
+
+typedef uint8_t byte;
+#define HEX 16
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define LED_BUILTIN 2
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// replaces the clock with a fake one, moved only by delay(), which then
+// returns at once instead of calling nanosleep, so the time-dependent logic
+// runs deterministically
+void setFakeClock(bool value);
+void yield();
+long random(long a, long b);
+long random(long b);
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class String {
+public:
+    std::string s;
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const std::string &c) : s(c) {}
+    String(const uint8_t *c, unsigned int len) : s((const char *)c, len) {}
+    String(char c) : s(1, c) {}
+    String(int v, unsigned char base = 10) { char b[34]; if (base == 16) snprintf(b, sizeof b, "%x", v); else snprintf(b, sizeof b, "%d", v); s = b; }
+    String(unsigned int v, unsigned char base = 10) { char b[34]; snprintf(b, sizeof b, base == 16 ? "%x" : "%u", v); s = b; }
+    String(long v, unsigned char base = 10) { char b[34]; snprintf(b, sizeof b, base == 16 ? "%lx" : "%ld", v); s = b; }
+    String(unsigned long v, unsigned char base = 10) { char b[34]; snprintf(b, sizeof b, base == 16 ? "%lx" : "%lu", v); s = b; }
+    String(float v, unsigned char dec = 2) { char b[64]; snprintf(b, sizeof b, "%.*f", dec, v); s = b; }
+    String(double v, unsigned char dec = 2) { char b[64]; snprintf(b, sizeof b, "%.*f", dec, v); s = b; }
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    int indexOf(char c) const { auto p = s.find(c); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(char c, unsigned int from) const { auto p = s.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+    String substring(unsigned int a) const { return a > s.size() ? String() : String(s.substr(a)); }
+    String substring(unsigned int a, unsigned int b) const { if (a > s.size()) return String(); return String(s.substr(a, b - a)); }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+    void toCharArray(char *buf, unsigned int n) const { strncpy(buf, s.c_str(), n); if (n) buf[n - 1] = 0; }
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator==(const char *o) const { return s == o; }
+    bool operator!=(const String &o) const { return s != o.s; }
+    bool operator!=(const char *o) const { return s != o; }
+    bool equals(const char *o) const { return s == o; }
+    String &operator+=(const String &o) { s += o.s; return *this; }
+    String &operator+=(const char *o) { s += o; return *this; }
+    String &operator+=(char o) { s += o; return *this; }
+    bool concat(const char *o) { s += o; return true; }
+    bool concat(const char *o, unsigned int n) { s.append(o, n); return true; }
+    bool concat(char o) { s += o; return true; }
+    bool reserve(unsigned int n) { s.reserve(n); return true; }
+    char operator[](unsigned int i) const { return s[i]; }
+    bool startsWith(const char *p) const { return s.rfind(p, 0) == 0; }
+    bool isEmpty() const { return s.empty(); }
+};
+inline String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+inline String operator+(const String &a, const char *b) { return String(a.s + b); }
+inline String operator+(const char *a, const String &b) { return String(a + b.s); }
+
+class Print {
+public:
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t n) { size_t r = 0; while (n--) r += write(*buf++); return r; }
+    size_t write(const char *buf, size_t n) { return write((const uint8_t *)buf, n); }
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t println() { return print("\n"); }
+    template <typename T> size_t println(T v) { size_t r = print(v); return r + println(); }
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) { char b[1024]; va_list a; va_start(a, fmt); int n = vsnprintf(b, sizeof b, fmt, a); va_end(a); return write((const uint8_t *)b, n < (int)sizeof b ? n : sizeof b - 1); }
+    virtual void flush() {}
+    virtual ~Print() {}
+};
+class Stream : public Print {
+public:
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual int peek() { return -1; }
+    long parseInt() { long v = 0; int c; while ((c = read()) >= '0' && c <= '9') v = v * 10 + (c - '0'); return v; }
+};
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { fputc(c, stdout); return 1; }
+    using Print::write;
+    size_t write(const uint8_t *b, size_t n) override { return fwrite(b, 1, n, stdout); }
+    int availableForWrite() { return 128; }
+    operator bool() { return true; }
+};
+extern HardwareSerial Serial;
+
+class IPAddress {
+public:
+    bool fromString(const String &s) { return s.length() && isdigit(s[0]); }
+    String toString() const { return String("192.168.1.2"); }
+};
+
+class EspClass {
+public:
+    uint32_t getChipId() { return 0xABCDEF; }
+    uint64_t getEfuseMac() { return 0x112233445566ULL; }
+    String getSketchMD5() { return String("d41d8cd98f00b204e9800998ecf8427e"); }
+    void restart() { exit(0); }
+    uint32_t getCycleCount() { return (uint32_t)(micros() * 80); }
+    uint32_t getCpuFreqMHz() { return 80; }
+    uint32_t getFreeHeap() { return 40000; }
+};
+extern EspClass ESP;
@@ -0,0 +1,61 @@
+#pragma once
+
+// host stand-in for ArduinoJson, a document is a map of strings; like
+// StaticJsonDocument it does not allocate when an existing field is read or
+// set to a value not longer than before, only adding a field allocates
+
+#include <Arduino.h>
+#include <map>
+#include <stdio.h>
+#include <vector>
+struct JsonVariantStub {
+    std::string v;
+    operator String() const { return String(v); }
+    operator const char *() const { return v.c_str(); }
+    operator int() const { return atoi(v.c_str()); }
+    operator long() const { return atol(v.c_str()); }
+    operator float() const { return atof(v.c_str()); }
+};
+class JsonObject {
+public:
+    std::map<std::string, JsonVariantStub> *m = nullptr;
+    JsonVariantStub operator[](const char *k) const { return (*m)[k]; }
+};
+class JsonArray {
+public:
+    std::vector<JsonObject> items;
+    std::vector<JsonObject>::iterator begin() { return items.begin(); }
+    std::vector<JsonObject>::iterator end() { return items.end(); }
+};
+class JsonDocumentStub {
+public:
+    std::map<std::string, JsonVariantStub, std::less<>> m;
+    bool containsKey(const char *k) const { return m.count(k) > 0; }
+    struct Ref {
+        JsonVariantStub &v;
+        Ref &operator=(const String &s) { v.v = s.c_str(); return *this; }
+        Ref &operator=(const char *s) { v.v = s; return *this; }
+        Ref &operator=(char *s) { v.v = s; return *this; }
+        Ref &operator=(int s) { return format("%d", s); }
+        Ref &operator=(long s) { return format("%ld", s); }
+        Ref &operator=(unsigned long s) { return format("%lu", s); }
+        Ref &operator=(unsigned int s) { return format("%u", s); }
+        Ref &operator=(float s) { return format("%f", (double)s); }
+        template <typename T> Ref &format(const char *f, T s) { char b[32]; snprintf(b, sizeof(b), f, s); v.v.assign(b); return *this; }
+        template <typename T> operator T() const { return (T)v; }
+    };
+    Ref operator[](const char *k) { return Ref{find(k)}; }
+    Ref operator[](char *k) { return Ref{find(k)}; }
+    JsonVariantStub &find(const char *k) { auto i = m.find(k); return i != m.end() ? i->second : m[k]; }
+    template <typename T> T as() { return T(); }
+    void clear() { m.clear(); }
+};
+template <int N> class StaticJsonDocument : public JsonDocumentStub {};
+class DeserializationError {
+public:
+    bool err = false;
+    operator bool() const { return err; }
+    const char *c_str() const { return "Ok"; }
+};
+template <typename D, typename S> DeserializationError deserializeJson(D &, S &&) { return DeserializationError(); }
+template <typename D, typename S> size_t serializeJson(const D &, S &&) { return 0; }
@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+typedef enum { OTA_AUTH_ERROR, OTA_BEGIN_ERROR, OTA_CONNECT_ERROR, OTA_RECEIVE_ERROR, OTA_END_ERROR } ota_error_t;
+#define U_FLASH 0
+#include <LittleFS.h>
+class ArduinoOTAClass {
+public:
+    void setPort(uint16_t) {}
+    void setHostname(const char *) {}
+    void setPasswordHash(const char *) {}
+    int getCommand() { return U_FLASH; }
+    ArduinoOTAClass &onStart(std::function<void()>) { return *this; }
+    ArduinoOTAClass &onEnd(std::function<void()>) { return *this; }
+    ArduinoOTAClass &onProgress(std::function<void(unsigned int, unsigned int)>) { return *this; }
+    ArduinoOTAClass &onError(std::function<void(ota_error_t)>) { return *this; }
+    void begin() {}
+    void handle() {}
+};
+extern ArduinoOTAClass ArduinoOTA;
@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL, WL_SCAN_COMPLETED, WL_CONNECTED, WL_CONNECT_FAILED, WL_CONNECTION_LOST, WL_DISCONNECTED } wl_status_t;
+typedef uint32_t u32_t;
+#define WIFI_MODE_NULL 0
+class WiFiClass {
+public:
+    wl_status_t st = WL_DISCONNECTED;
+    unsigned long beganAt = 0; bool began = false; unsigned long failUntil = 0;
+    void enableAP(int) {}
+    void hostname(const char *) {}
+    void setHostname(const char *) {}
+    void config(u32_t, u32_t, u32_t) {}
+    void mode(int) {}
+    void begin(const char *, const char *) { began = true; beganAt = millis(); }
+    wl_status_t status() { if (began && millis() - beganAt > 300 && millis() >= failUntil) st = WL_CONNECTED; return st; }
+    bool isConnected() { return status() == WL_CONNECTED; }
+    IPAddress localIP() { return IPAddress(); }
+    String SSID() { return String("ssid"); }
+};
+extern WiFiClass WiFi;
+class WiFiClient : public Client {};
@@ -0,0 +1,4 @@
+#pragma once
+#include <Arduino.h>
+class MDNSResponder { public: bool begin(const String &) { return true; } void addService(const char *, const char *, uint16_t) {} void addServiceTxt(const char *, const char *, const char *, const char *) {} };
+extern MDNSResponder MDNS;
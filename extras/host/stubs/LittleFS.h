@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#include <string>
+#include <map>
+// host stand-in backed by memory
+struct FileData { std::string content; };
+class File : public Stream {
+public:
+    std::shared_ptr<FileData> d; size_t pos = 0; bool valid = false; std::string n;
+    File() {}
+    operator bool() const { return valid; }
+    size_t size() { return d ? d->content.size() : 0; }
+    size_t write(uint8_t c) override { d->content.push_back((char)c); return 1; }
+    size_t write(const uint8_t *b, size_t len) override { d->content.append((const char *)b, len); return len; }
+    using Print::write;
+    int available() override { return d ? (int)(d->content.size() - pos) : 0; }
+    int read() override { return available() ? (uint8_t)d->content[pos++] : -1; }
+    size_t read(uint8_t *b, size_t len) { size_t a = available(); if (len > a) len = a; memcpy(b, d->content.data() + pos, len); pos += len; return len; }
+    bool seek(size_t p) { pos = p; return true; }
+    size_t position() { return pos; }
+    void close() { valid = false; }
+    const char *name() { return n.c_str(); }
+};
+namespace fs {
+class FS {
+public:
+    std::map<std::string, std::shared_ptr<FileData>> files;
+    bool begin() { return true; }
+    bool format() { files.clear(); return true; }
+    void end() {}
+    bool exists(const char *p) { return files.count(p); }
+    bool exists(const String &p) { return files.count(p.c_str()); }
+    bool mkdir(const char *) { return true; }
+    bool remove(const char *p) { return files.erase(p) > 0; }
+    bool remove(const String &p) { return remove(p.c_str()); }
+    File open(const String &p, const char *mode) { return open(p.c_str(), mode); }
+    File open(const char *p, const char *mode) {
+        File f; f.n = p;
+        if (mode[0] == 'r') { if (!files.count(p)) return f; f.d = files[p]; }
+        else if (mode[0] == 'w') { f.d = files[p] = std::make_shared<FileData>(); }
+        else { if (!files.count(p)) files[p] = std::make_shared<FileData>(); f.d = files[p]; f.pos = f.d->content.size(); }
+        f.valid = true; return f;
+    }
+};
+}
+using fs::FS;
+extern fs::FS LittleFS;
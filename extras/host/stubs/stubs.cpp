@@ -0,0 +1,30 @@
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <LittleFS.h>
+#include <ArduinoOTA.h>
+#include <ESP8266mDNS.h>
+#include <time.h>
+static auto t0 = std::chrono::steady_clock::now();
+static bool isFakeClock = false;
+static uint64_t fakeMicros = 0;
+static uint64_t realMicros() { return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count(); }
+static void sleepMicros(uint64_t us)
+{
+    if (isFakeClock) { fakeMicros += us; return; }
+    timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    while (nanosleep(&ts, &ts) != 0) {}
+}
+void setFakeClock(bool value) { if (value && !isFakeClock) fakeMicros = realMicros(); isFakeClock = value; }
+unsigned long millis() { return (isFakeClock ? fakeMicros : realMicros()) / 1000; }
+unsigned long micros() { return isFakeClock ? fakeMicros : realMicros(); }
+void delay(unsigned long ms) { sleepMicros((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { sleepMicros(us); }
+void yield() {}
+long random(long a, long b) { return a + rand() % (b - a); }
+long random(long b) { return rand() % b; }
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+fs::FS LittleFS;
+ArduinoOTAClass ArduinoOTA;
+MDNSResponder MDNS;
@@ -0,0 +1,73 @@
+#include <Mokosh.hpp>
+#include <MokoshBinaryLogger.hpp>
+#include <string>
+
+// checks that the records of BinaryLogger are complete and never longer
+// than 257 bytes, also when the '*' arguments fill the record before a
+// string; best built with -fsanitize=address, which reports any write past
+// the record
+Mokosh mokosh("Mokosh", "1.0.0", false, false);
+
+class Capture : public Print
+{
+public:
+    std::string data;
+
+    virtual size_t write(uint8_t c) override
+    {
+        this->data.push_back((char)c);
+        return 1;
+    }
+
+    virtual size_t write(const uint8_t *buffer, size_t size) override
+    {
+        this->data.append((const char *)buffer, size);
+        return size;
+    }
+};
+
+static Capture output;
+
+// returns the number of records, or -1 if they are malformed
+static int countRecords()
+{
+    int count = 0;
+    size_t pos = 0;
+    while (pos < output.data.size())
+    {
+        if ((uint8_t)output.data[pos] != BinaryLogger::SYNC || pos + 2 > output.data.size())
+            return -1;
+
+        pos += 2 + (uint8_t)output.data[pos + 1];
+        count++;
+    }
+
+    return pos == output.data.size() ? count : -1;
+}
+
+int main()
+{
+    mokosh.registerLogger(std::make_shared<BinaryLogger>(output));
+
+    std::string text(240, 'x');
+    std::string longText(400, 'y');
+
+    mlogI("Value %d, %s", 42, "short");
+    mlogI("%s", longText.c_str());
+
+    // the string fills the record up to 254 bytes, the two '*' arguments
+    // fill it to the end, no place is left for the next string
+    mlogI("%s%*.*s", text.c_str(), 10, 5, "abcdefgh");
+    mlogI("%s%*d%s", text.c_str(), 10, 7, "tail");
+
+    int count = countRecords();
+    printf("%zu bytes, %d records\n", output.data.size(), count);
+    if (count != 4)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
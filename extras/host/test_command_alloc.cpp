@@ -0,0 +1,114 @@
+#include <Mokosh.hpp>
+#include <new>
+
+// counts heap allocations of a command, from the MQTT callback to the
+// handler; the commands handled on views must not allocate at all, the
+// commands taking String are only reported
+//
+// with the small string buffer, short Strings would not allocate, so it
+// is disabled:
+//   ./build.sh test_command_alloc.cpp -D_GLIBCXX_USE_CXX11_ABI=0
+#if _GLIBCXX_USE_CXX11_ABI
+#error "build with -D_GLIBCXX_USE_CXX11_ABI=0, so every non-empty String allocates"
+#endif
+
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+static long allocations = 0;
+static bool isCounting = false;
+
+void *operator new(size_t size)
+{
+    if (isCounting)
+        allocations++;
+
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+struct Case
+{
+    const char *command;
+    bool isAllocationFree;
+};
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+
+    mokosh.registerCommand("blink", [](MokoshStringView param)
+                           { volatile long n = param.toInt(); (void)n; });
+    mokosh.registerCommand("legacy", [](const String &param)
+                           { volatile long n = param.toInt(); (void)n; });
+
+    mokosh.begin();
+    unsigned long start = millis();
+    while (millis() - start < 1000)
+        mokosh.loop();
+
+    auto mqtt = std::static_pointer_cast<PubSubClientService>(mokosh.getMqttService());
+    if (mqtt == nullptr || !mqtt->isConnected())
+    {
+        printf("MQTT is not connected\n");
+        return 1;
+    }
+
+    String topic = mokosh.getMqttPrefix() + "cmd";
+
+    Case cases[] = {
+        {"dutycycle=reset", true},
+        {"setdebuglevel=network:3", true},
+        {"setdebuglevel=network:", true},
+        {"blink=3", true},
+        {"setconfigi=foo|7", true},
+        {"showconfigi=foo", true},
+        {"setconfigf=bar|1.5", true},
+        {"showconfigf=bar", true},
+        {"setconfigs=baz|hello world", true},
+        {"showconfigs=baz", true},
+        {"legacy=3", false},
+    };
+
+    int failed = 0;
+    for (auto &c : cases)
+    {
+        // the buffer of the MQTT client is not null-terminated
+        char buffer[128];
+        size_t length = strlen(c.command);
+        memcpy(buffer, c.command, length);
+        buffer[length] = '#';
+
+        // the first run may add the field to the configuration
+        mqtt->_mqttCommandReceived((char *)topic.c_str(), (uint8_t *)buffer, length);
+
+        allocations = 0;
+        isCounting = true;
+        for (int i = 0; i < 100; i++)
+            mqtt->_mqttCommandReceived((char *)topic.c_str(), (uint8_t *)buffer, length);
+        isCounting = false;
+
+        bool isFailed = c.isAllocationFree && allocations > 0;
+        if (isFailed)
+            failed++;
+
+        printf("%-28s %.2f allocations%s\n", c.command, allocations / 100.0, isFailed ? "  FAILED" : "");
+    }
+
+    if (failed > 0)
+    {
+        printf("%d commands allocated\n", failed);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
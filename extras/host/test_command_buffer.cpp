@@ -0,0 +1,71 @@
+#include <Mokosh.hpp>
+#include <MokoshMqttLogger.hpp>
+
+// checks that a command is handled correctly when something is published
+// while it is handled: the MQTT client keeps the received message in the
+// buffer it publishes from, so the stub overwrites it on every publish, and
+// the logs are published by MqttLogger
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+static char received[32] = {0};
+
+static void handle(const char *command)
+{
+    auto mqtt = std::static_pointer_cast<PubSubClientService>(mokosh.getMqttService());
+    String topic = mokosh.getMqttPrefix() + "cmd";
+
+    size_t length = strlen(command);
+    memcpy(PubSubClient::buffer, command, length);
+    mqtt->_mqttCommandReceived((char *)topic.c_str(), PubSubClient::buffer, length);
+}
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+
+    // errors are published immediately, and the buffer is small, so the
+    // logs of handling a command are published before it is finished
+    auto logger = std::make_shared<MqttLogger>(100, 60000);
+    logger->setLevel(LogLevel::DEBUG);
+    mokosh.registerLogger(logger);
+
+    mokosh.registerCommand("echo", [](MokoshStringView param)
+                           {
+                               mlogE("Echo is publishing before reading the parameter");
+                               param.copyTo(received, sizeof(received)); });
+
+    mokosh.begin();
+    unsigned long start = millis();
+    while (millis() - start < 1000)
+        mokosh.loop();
+
+    if (!mokosh.getMqttService()->isConnected())
+    {
+        printf("MQTT is not connected\n");
+        return 1;
+    }
+
+    int failed = 0;
+
+    handle("echo=hello world");
+    printf("echo: %s\n", received);
+    if (strcmp(received, "hello world") != 0)
+        failed++;
+
+    handle("setconfigs=greeting|hello world");
+    String greeting = mokosh.config->get<String>("greeting");
+    printf("greeting: %s\n", greeting.c_str());
+    if (greeting != "hello world")
+        failed++;
+
+    if (failed > 0)
+    {
+        printf("%d commands were overwritten\n", failed);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <Mokosh.hpp>
+#include <MokoshFileLogger.hpp>
+#include <string>
+
+// checks FileLogger on the LittleFS stub, kept in memory: lines are kept in
+// the page until an error flushes them, segments are rotated with the
+// index wrapping around, a new logger continues the current segment, and
+// dumplogs publishes all segments, oldest first, in chunks
+Mokosh mokosh("Mokosh", "1.0.0", false, false);
+
+static int failed = 0;
+
+static void check(const char *title, bool isPassed)
+{
+    printf("%-48s %s\n", title, isPassed ? "ok" : "FAILED");
+    if (!isPassed)
+        failed++;
+}
+
+static std::string content(const char *path)
+{
+    return LittleFS.exists(path) ? LittleFS.files[path]->content : std::string();
+}
+
+static std::string segment(int number)
+{
+    return content((std::string("/logs/") + std::to_string(number) + ".log").c_str());
+}
+
+static int index()
+{
+    return atoi(content("/logs/index").c_str());
+}
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+
+    // 3 segments of 600 bytes, written in 200 bytes pages, the interval is
+    // long, so only a full page or an error writes them
+    auto logger = std::make_shared<FileLogger>(600, 3, 200, 100000);
+    mokosh.registerLogger(logger);
+    mokosh.setLogLevel(LogLevel::INFO);
+    mokosh.begin();
+
+    unsigned long start = millis();
+    while (millis() - start < 1000)
+        mokosh.loop();
+
+    // the lines logged on start are written, from the marker in the first
+    // segment, and there is space left in the current one
+    logger->flush();
+    std::string before = segment(index());
+    check("the lines logged on start are written", segment(0).find("=== boot ===") == 0 && before.size() > 0 && before.size() < 400);
+
+    mlogI("Kept in the page");
+    check("a line is kept in the page", segment(index()) == before);
+
+    mlogE("Flushed with the page");
+    std::string written = segment(index());
+    check("an error writes the page", written.find("Kept in the page") != std::string::npos && written.find("Flushed with the page") != std::string::npos);
+    check("the page is appended to the segment", written.size() > before.size() && written.compare(0, before.size(), before) == 0);
+
+    // every line is about 80 bytes, so 40 of them fill all 3 segments twice
+    std::string indexes = std::to_string(index());
+    for (int i = 0; i < 40; i++)
+    {
+        mlogI("Line number %03d of the rotation test", i);
+
+        std::string current = std::to_string(index());
+        if (current != indexes.substr(indexes.size() - 1))
+            indexes += current;
+    }
+    logger->flush();
+
+    printf("indexes %s, segments %zu %zu %zu\n", indexes.c_str(), segment(0).size(), segment(1).size(), segment(2).size());
+    check("the index wraps around", indexes.find("120") != std::string::npos || indexes.find("201") != std::string::npos);
+    check("the segments are not larger than 600 bytes", segment(0).size() <= 600 && segment(1).size() <= 600 && segment(2).size() <= 600);
+    check("only 3 segments exist", !LittleFS.exists("/logs/3.log"));
+
+    std::string all = segment(0) + segment(1) + segment(2);
+    check("the oldest lines are overwritten", all.find("Line number 000") == std::string::npos);
+    check("the newest line is in the current segment", segment(index()).find("Line number 039") != std::string::npos);
+
+    // a logger created after a reset continues where the previous one ended
+    FileLogger restarted(600, 3, 200, 100000);
+    restarted.setup();
+    restarted.log(LogLevel::ERROR, "main", "test_file_logger.cpp", 1, 0, "After the reset");
+    check("a new logger continues the current segment", segment(index()).find("After the reset") != std::string::npos);
+
+    // dumplogs publishes the segments from the oldest one
+    std::string dumped;
+    int chunks = 0;
+    bool isTooLong = false;
+    bool isEnded = false;
+    PubSubClient::onPublish = [&](const char *topic, const char *payload)
+    {
+        if (strstr(topic, "debug/logs") == nullptr)
+            return;
+
+        if (payload[0] == 0)
+        {
+            isEnded = true;
+            return;
+        }
+
+        chunks++;
+        isTooLong = isTooLong || strlen(payload) > FileLogger::DUMP_CHUNK_SIZE;
+        dumped += payload;
+    };
+
+    mokosh._processCommand("dumplogs");
+    start = millis();
+    while (logger->isDumpInProgress() && millis() - start < 5000)
+        mokosh.loop();
+    PubSubClient::onPublish = nullptr;
+
+    // the command itself is logged and flushed before the dump starts
+    std::string expected = segment((index() + 1) % 3) + segment((index() + 2) % 3) + segment(index());
+    printf("dumped %zu bytes in %d chunks\n", dumped.size(), chunks);
+    check("dumplogs ends with an empty message", isEnded);
+    check("dumplogs publishes chunks up to 128 bytes", !isTooLong && chunks >= (int)(expected.size() / FileLogger::DUMP_CHUNK_SIZE));
+    check("dumplogs publishes all segments, oldest first", dumped == expected);
+
+    if (failed > 0)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <Mokosh.hpp>
+
+// runs the idle mode for 10 s of a fake clock, which is moved only by the
+// sleeps of loop(): a 250 ms timer must run exactly 40 times, loop() must
+// sleep between the deadlines instead of spinning, never longer than the
+// MQTT service allows, and the whole time must be counted as idle
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::ERROR);
+
+    setFakeClock(true);
+    mokosh.begin();
+
+    int ticks = 0;
+    unsigned long lastTick = millis();
+    unsigned long maxTickGap = 0;
+    mokosh.registerIntervalFunction([&]()
+                                    {
+                                        ticks++;
+                                        maxTickGap = std::max(maxTickGap, millis() - lastTick);
+                                        lastTick = millis(); },
+                                    250);
+
+    mokosh.setIdleMode(true, 1000);
+
+    // the sleeps are taken from the time between the iterations, loop()
+    // itself takes no time on the fake clock
+    int loops = 0;
+    unsigned long maxSleep = 0;
+    unsigned long start = millis();
+    while (millis() - start <= 10000 && loops < 100000)
+    {
+        unsigned long before = millis();
+        mokosh.loop();
+        maxSleep = std::max(maxSleep, millis() - before);
+        loops++;
+    }
+
+    printf("%d loops, %d ticks, longest sleep %lu ms, longest gap between ticks %lu ms\n", loops, ticks, maxSleep, maxTickGap);
+    mokosh._processCommand("dutycycle");
+
+    // MQTT wants to be polled every 100 ms, so there are about 100 sleeps
+    // and the ones ended by the timer
+    if (ticks != 40 || maxTickGap != 250 || maxSleep > 100 || loops > 200)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
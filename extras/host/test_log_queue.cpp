@@ -0,0 +1,48 @@
+#include <MokoshLogQueue.hpp>
+
+// checks the capacity of the log queue, rounded up to a power of two, also
+// for 0, and the order of the records kept by both overflow policies
+static int failed = 0;
+
+static void check(size_t capacity, LogOverflowPolicy policy, int pushed, const char *expected)
+{
+    MokoshLogQueue queue(capacity, policy);
+
+    char msg[16];
+    for (int i = 0; i < pushed; i++)
+    {
+        snprintf(msg, sizeof(msg), "%d", i);
+        queue.push(LogLevel::INFO, false, nullptr, __func__, __FILE__, __LINE__, millis(), msg);
+    }
+
+    char actual[64] = {0};
+    MokoshLogRecord record;
+    while (queue.pop(record))
+        strncat(actual, record.msg, sizeof(actual) - strlen(actual) - 1);
+
+    bool isFailed = strcmp(actual, expected) != 0 || queue.getDropped() != pushed - strlen(expected);
+    if (isFailed)
+        failed++;
+
+    printf("capacity %zu (%zu), %d pushed: '%s', %u dropped%s\n", capacity, queue.getCapacity(), pushed, actual, queue.getDropped(), isFailed ? "  FAILED" : "");
+}
+
+int main()
+{
+    check(0, LogOverflowPolicy::DROP_OLDEST, 3, "2");
+    check(0, LogOverflowPolicy::DROP_NEWEST, 3, "0");
+    check(1, LogOverflowPolicy::DROP_OLDEST, 2, "1");
+    check(3, LogOverflowPolicy::DROP_OLDEST, 6, "2345");
+    check(3, LogOverflowPolicy::DROP_NEWEST, 6, "0123");
+    check(5, LogOverflowPolicy::DROP_OLDEST, 10, "23456789");
+    check(8, LogOverflowPolicy::DROP_NEWEST, 5, "01234");
+
+    if (failed > 0)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <Mokosh.hpp>
+#include <MokoshMqttLogger.hpp>
+
+// checks that with asynchronous logging MqttLogger does not publish the
+// messages logged by its own publishing, which would make it publish again
+// forever, while the level set for the tag of PubSubClientService.hpp still
+// applies to them, so the other loggers get them
+Mokosh mokosh("Mokosh", "1.0.0", false, false);
+
+// a logger counting the messages logged by publishing
+class Capture : public MokoshLogger
+{
+public:
+    virtual bool setup() override { return true; }
+    virtual void loop() override {}
+    virtual void ticker_step() override {}
+    virtual void ticker_finish(bool success) override {}
+
+    virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) override
+    {
+        if (strncmp(msg, "Publishing message", 18) == 0)
+            publishingCount++;
+    }
+
+    unsigned long publishingCount = 0;
+};
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+
+    auto capture = std::make_shared<Capture>();
+    mokosh.registerLogger(capture);
+
+    auto logger = std::make_shared<MqttLogger>(192, 200);
+    mokosh.registerLogger(logger);
+
+    mokosh.setLogLevel(LogLevel::INFO);
+    mokosh.setLogLevel("PubSubClientService.hpp", LogLevel::DEBUG);
+    mokosh.setAsyncLogging(16);
+    mokosh.begin();
+
+    for (int i = 0; i < 5; i++)
+        mlogI("Line %d", i);
+
+    unsigned long start = millis();
+    while (millis() - start < 1000)
+        mokosh.loop();
+
+    // only the lines logged on start are published, and nothing after them;
+    // before, every flush logged a message causing the next one, until the
+    // limiter suppressed the repeated messages
+    unsigned long flushes = logger->getFlushCount();
+    start = millis();
+    while (millis() - start < 1000)
+        mokosh.loop();
+
+    printf("flushes %lu, then %lu, publishing logged %lu times\n", flushes, logger->getFlushCount(), capture->publishingCount);
+    if (flushes == 0 || flushes > 20 || logger->getFlushCount() != flushes || capture->publishingCount == 0)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <Mokosh.hpp>
+
+// checks that replacing a service after begin() updates the setup order:
+// X and Y depend on each other and fail, then Y is replaced with one
+// without dependencies, which breaks the cycle, so Y and then X are set up
+Mokosh mokosh("Mokosh", "1.0.0", false);
+
+static String order;
+
+class Recorded : public MokoshService
+{
+public:
+    Recorded(const char *name, std::vector<const char *> dependencies) : name(name), dependencies(dependencies) {}
+
+    virtual bool setup() override
+    {
+        order += this->name;
+        return true;
+    }
+
+    virtual void loop() override {}
+
+    virtual std::vector<const char *> getDependencies() override
+    {
+        return this->dependencies;
+    }
+
+private:
+    const char *name;
+    std::vector<const char *> dependencies;
+};
+
+int main()
+{
+    mokosh.config->set(mokosh.config->key_ssid, "yourssid");
+    mokosh.config->set(mokosh.config->key_broker, "192.168.1.10");
+    mokosh.setHeartbeat(false);
+    mokosh.setLogLevel(LogLevel::WARNING);
+
+    auto x = std::make_shared<Recorded>("X", std::vector<const char *>{"Y"});
+    mokosh.registerService("X", x);
+    mokosh.registerService("Y", std::make_shared<Recorded>("Y", std::vector<const char *>{"X"}));
+
+    mokosh.begin();
+    unsigned long start = millis();
+    while (millis() - start < 500)
+        mokosh.loop();
+
+    printf("set up before: '%s', X %d\n", order.c_str(), x->getState());
+    bool isFailed = order != "" || x->getState() != SERVICE_FAILED;
+
+    auto y = std::make_shared<Recorded>("Y", std::vector<const char *>{});
+    mokosh.registerService("Y", y);
+
+    start = millis();
+    while (millis() - start < 500)
+        mokosh.loop();
+
+    printf("set up after replacing Y: '%s', X %d, Y %d\n", order.c_str(), x->getState(), y->getState());
+    isFailed = isFailed || order != "YX" || x->getState() != SERVICE_READY || y->getState() != SERVICE_READY;
+
+    if (isFailed)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <MokoshScheduler.hpp>
+#include <new>
+
+// registers and expires 100k timeouts, in batches of 100, half of them
+// cancelled before they run, and checks that the memory does not grow: the
+// number of blocks allocated on the heap and the slots of the scheduler
+// are the same after the first batches and at the end
+static long blocks = 0;
+
+void *operator new(size_t size)
+{
+    blocks++;
+
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p != nullptr)
+        blocks--;
+
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+static const int BATCH = 100;
+static const int TOTAL = 100000;
+
+int main()
+{
+    MokoshScheduler scheduler;
+    long runs = 0;
+
+    long warmBlocks = 0;
+    size_t warmCapacity = 0;
+    size_t maxCapacity = 0;
+
+    MokoshTimer timers[BATCH];
+    for (int registered = 0; registered < TOTAL; registered += BATCH)
+    {
+        for (int i = 0; i < BATCH; i++)
+            timers[i] = scheduler.add([&runs]()
+                                      { runs++; }, 1 + i % 3, 1);
+
+        for (int i = 0; i < BATCH; i += 2)
+            timers[i].cancel();
+
+        while (scheduler.getCount() > 0)
+            scheduler.update();
+
+        // a handle of a finished timer does nothing
+        timers[1].cancel();
+        timers[1].restart();
+
+        maxCapacity = std::max(maxCapacity, scheduler.getCapacity());
+        if (registered == 10 * BATCH)
+        {
+            warmBlocks = blocks;
+            warmCapacity = scheduler.getCapacity();
+        }
+    }
+
+    printf("%d timeouts, %ld run, %zu slots at most, %ld blocks after %d and %ld at the end\n",
+           TOTAL, runs, maxCapacity, warmBlocks, 10 * BATCH, blocks);
+
+    if (runs != TOTAL / 2 || blocks != warmBlocks || scheduler.getCapacity() != warmCapacity)
+    {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
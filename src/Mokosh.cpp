@@ -3,11 +3,29 @@
 static Mokosh *_instance;
 
 std::vector<std::shared_ptr<MokoshLogger>> Mokosh::loggers;
+std::vector<std::shared_ptr<MokoshLogger>> Mokosh::rawLoggers;
+LogLevel Mokosh::minLogLevel = LogLevel::ANY;
+LogLevel Mokosh::minFormattedLogLevel = LogLevel::ANY;
+Mokosh::TagLogLevel Mokosh::tagLogLevels[MOKOSH_LOG_TAGS];
+int Mokosh::tagLogLevelsCount = 0;
+unsigned long Mokosh::logRateLimits[LogLevel::ANY + 1] = {
+    MOKOSH_LOG_RATE_LIMIT_WINDOW,
+    MOKOSH_LOG_RATE_LIMIT_WINDOW,
+    MOKOSH_LOG_RATE_LIMIT_WINDOW,
+    MOKOSH_LOG_RATE_LIMIT_WINDOW,
+    MOKOSH_LOG_RATE_LIMIT_WINDOW,
+    MOKOSH_LOG_RATE_LIMIT_ERROR_WINDOW,
+    MOKOSH_LOG_RATE_LIMIT_WINDOW};
+std::unique_ptr<MokoshLogQueue> Mokosh::logQueue;
+int Mokosh::logDrainPerLoop = 8;
+bool Mokosh::isLogTaskRunning = false;
 
 Mokosh::Mokosh(String prefix, String version, bool useFilesystem, bool useSerial)
 {
     _instance = this;
 
+    this->registerBuiltInCommands();
+
     this->version = version;
 
     if (useSerial)
@@ -58,6 +76,18 @@ Mokosh::Mokosh(String prefix, String version, bool useFilesystem, bool useSerial
     mlogV("ID: %s, overridden to %s", hostString, OVERRIDE_HOSTNAME);
 #endif
 
+    // the first overrun in a row is logged, so a slow timer does not flood
+    // the logs
+    this->scheduler.onOverrun = [](MokoshTimer &timer, unsigned long duration)
+    {
+        const MokoshExecutionStats *stats = timer.getExecutionStats();
+        if (stats->consecutiveOverruns == 1)
+            mlogW("Timer %d took %lu us, over the budget of %lu us", (int)timer.getId(), duration, stats->budget);
+
+        if (timer.getDemotion() > 0 && stats->consecutiveOverruns == 0)
+            mlogW("Timer %d demoted, its period is %d times longer", (int)timer.getId(), 1 << timer.getDemotion());
+    };
+
     // config service is set up in the beginning, and immediately
     this->registerService(MokoshConfig::KEY, std::make_shared<MokoshConfig>(useFilesystem));
     this->config = this->getRegisteredService<MokoshConfig>(MokoshConfig::KEY);
@@ -69,16 +99,258 @@ Mokosh::Mokosh(String prefix, String version, bool useFilesystem, bool useSerial
 
 void Mokosh::log(LogLevel level, const char *func, const char *file, int line, const char *fmt, ...)
 {
-    char dest[256];
-    va_list argptr;
-    va_start(argptr, fmt);
-    vsprintf(dest, fmt, argptr);
-    va_end(argptr);
+    va_list args;
+    va_start(args, fmt);
+    Mokosh::vlog(level, 0, nullptr, func, file, line, fmt, args);
+    va_end(args);
+}
+
+void Mokosh::log(LogLevel level, uint32_t tag, MokoshLogSite *site, const char *func, const char *file, int line, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    Mokosh::vlog(level, tag, site, func, file, line, fmt, args);
+    va_end(args);
+}
+
+// passes the formatted chunks to the logger
+class MokoshLoggerSink : public MokoshFormatSink
+{
+public:
+    MokoshLoggerSink(MokoshLogger *logger) : logger(logger)
+    {
+    }
+
+    virtual void write(const char *chunk, size_t length) override
+    {
+        this->logger->logWrite(chunk, length);
+    }
+
+private:
+    MokoshLogger *logger;
+};
+
+void Mokosh::vlog(LogLevel level, uint32_t tag, MokoshLogSite *site, const char *func, const char *file, int line, const char *fmt, va_list argptr)
+{
+    // if there is a level set for the tag, it is used instead of the levels
+    // of the loggers
+    bool isTagged = false;
+    if (Mokosh::tagLogLevelsCount > 0)
+    {
+        for (int i = 0; i < Mokosh::tagLogLevelsCount; i++)
+        {
+            if (Mokosh::tagLogLevels[i].tag == tag)
+            {
+                if (level < Mokosh::tagLogLevels[i].level)
+                    return;
+
+                isTagged = true;
+                break;
+            }
+        }
+    }
+
+    // no logger will accept that message, so there is no need to format it
+    if (!isTagged && level < Mokosh::minLogLevel)
+        return;
+
+#if MOKOSH_EXECUTOR
+    // the loggers are not thread-safe, so the messages from the executor are
+    // formatted there and passed to them by the main loop
+    if (_instance != nullptr && _instance->isInExecutor())
+    {
+        char msg[MOKOSH_LOG_RECORD_SIZE];
+        MokoshBufferSink sink(msg, sizeof(msg));
+        MokoshFormat::format(sink, fmt, argptr);
+
+        String text(msg);
+        _instance->post([level, tag, func, file, line, text]()
+                        { Mokosh::log(level, tag, nullptr, func, file, line, "%s", text.c_str()); });
+        return;
+    }
+#endif
+
+    bool isFormatted = isTagged || level >= Mokosh::minFormattedLogLevel;
+
+    if (site != nullptr && Mokosh::logRateLimits[level] > 0)
+    {
+        // the same arguments give the same message, so it doesn't need to be
+        // formatted to find out if it is repeated
+        uint32_t hash = MokoshFormat::hash(fmt, argptr);
+        unsigned long now = millis();
+
+        if (hash == site->lastHash && now - site->lastTime < Mokosh::logRateLimits[level])
+        {
+            if (site->suppressed < UINT16_MAX)
+                site->suppressed++;
+
+            return;
+        }
+
+        if (site->suppressed > 0)
+        {
+            unsigned int suppressed = site->suppressed;
+            site->suppressed = 0;
+            Mokosh::log(level, tag, nullptr, func, file, line, "Previous message repeated %u times", suppressed);
+        }
+
+        site->lastHash = hash;
+        site->lastTime = now;
+    }
+
+    for (auto &adapter : Mokosh::rawLoggers)
+    {
+        if (!isTagged && level < adapter->getLevel())
+            continue;
+
+        va_list args;
+        va_copy(args, argptr);
+        adapter->logRaw(level, func, file, line, millis(), fmt, args);
+        va_end(args);
+    }
+
+    if (!isFormatted)
+        return;
+
+    if (Mokosh::logQueue != nullptr)
+    {
+        // the queue keeps copies of the messages, so they are limited to
+        // MOKOSH_LOG_RECORD_SIZE
+        char msg[MOKOSH_LOG_RECORD_SIZE];
+        MokoshBufferSink sink(msg, sizeof(msg));
+        MokoshFormat::format(sink, fmt, argptr);
+
+        // a logger writing out now would get this message back later, when
+        // it could not recognize it anymore
+        MokoshLogger *writer = nullptr;
+        for (auto &adapter : Mokosh::loggers)
+        {
+            if (adapter->isWriting())
+                writer = adapter.get();
+        }
+
+        Mokosh::logQueue->push(level, isTagged, writer, func, file, line, millis(), msg);
+        return;
+    }
+
+    // the message is formatted separately for every logger and passed to it
+    // in chunks, so it is never stored as a whole
+    long time = millis();
+    for (auto &adapter : Mokosh::loggers)
+    {
+        if (!isTagged && level < adapter->getLevel())
+            continue;
+
+        MokoshLoggerSink sink(adapter.get());
+        adapter->logBegin(level, func, file, line, time);
+        MokoshFormat::format(sink, fmt, argptr);
+        adapter->logEnd();
+    }
+}
+
+void Mokosh::passToLoggers(LogLevel level, bool isTagged, MokoshLogger *writer, const char *func, const char *file, int line, long time, const char *msg)
+{
+    for (auto &adapter : Mokosh::loggers)
+    {
+        if ((isTagged || level >= adapter->getLevel()) && adapter.get() != writer)
+            adapter->log(level, func, file, line, time, msg);
+    }
+}
+
+#if defined(ESP32)
+static void logDrainTask(void *parameters)
+{
+    for (;;)
+    {
+        if (Mokosh::drainLogs(16) == 0)
+            vTaskDelay(1);
+    }
+}
+#endif
+
+Mokosh *Mokosh::setAsyncLogging(size_t capacity, LogOverflowPolicy policy, int drainPerLoop, bool useTask)
+{
+    if (Mokosh::logQueue != nullptr)
+    {
+        mlogE("Asynchronous logging is already enabled, ignoring.");
+        return this;
+    }
+
+    Mokosh::logDrainPerLoop = drainPerLoop;
+    Mokosh::logQueue.reset(new MokoshLogQueue(capacity, policy));
+
+    if (useTask)
+    {
+#if defined(ESP32)
+        if (xTaskCreate(logDrainTask, "mokosh_log", 4096, nullptr, 1, nullptr) == pdPASS)
+            Mokosh::isLogTaskRunning = true;
+        else
+            mlogE("Cannot create log task, logs will be passed in loop()");
+#else
+        mlogW("Log task is supported only on ESP32, logs will be passed in loop()");
+#endif
+    }
+
+    return this;
+}
+
+int Mokosh::drainLogs(int max)
+{
+    if (Mokosh::logQueue == nullptr)
+        return 0;
 
+    MokoshLogRecord record;
+    int count = 0;
+    while (count < max && Mokosh::logQueue->pop(record))
+    {
+        Mokosh::passToLoggers(record.level, record.isTagged, record.writer, record.func, record.file, record.line, record.time, record.msg);
+        count++;
+    }
+
+    return count;
+}
+
+void Mokosh::flushLogs()
+{
+    if (Mokosh::isLogTaskRunning)
+    {
+        // the task is the only consumer, waiting for it to empty the queue
+        while (Mokosh::logQueue->size() > 0)
+            delay(1);
+
+        return;
+    }
+
+    while (Mokosh::drainLogs(Mokosh::logDrainPerLoop) > 0)
+        ;
+}
+
+uint32_t Mokosh::getDroppedLogCount()
+{
+    if (Mokosh::logQueue == nullptr)
+        return 0;
+
+    return Mokosh::logQueue->getDropped();
+}
+
+void Mokosh::updateLogLevelCache()
+{
+    LogLevel min = LogLevel::ANY;
     for (auto &adapter : Mokosh::loggers)
     {
-        adapter->log(level, func, file, line, millis(), dest);
+        if (adapter->getLevel() < min)
+            min = adapter->getLevel();
+    }
+
+    Mokosh::minFormattedLogLevel = min;
+
+    for (auto &adapter : Mokosh::rawLoggers)
+    {
+        if (adapter->getLevel() < min)
+            min = adapter->getLevel();
     }
+
+    Mokosh::minLogLevel = min;
 }
 
 void Mokosh::debug_ticker_step()
@@ -103,9 +375,9 @@ Mokosh *Mokosh::setIPRetained(bool value)
     return this;
 }
 
-std::vector<std::shared_ptr<TickTwo>> Mokosh::getTickers()
+MokoshScheduler &Mokosh::getScheduler()
 {
-    return tickers;
+    return this->scheduler;
 }
 
 void Mokosh::hello()
@@ -143,10 +415,7 @@ void Mokosh::hello()
 void Mokosh::initializeTickers()
 {
     // starting all tickers
-    for (auto &ticker : tickers)
-    {
-        ticker->start();
-    }
+    this->scheduler.startAll();
 }
 
 String Mokosh::getVersion()
@@ -156,6 +425,8 @@ String Mokosh::getVersion()
 
 void Mokosh::begin(bool autoconnect)
 {
+    this->beginTime = millis();
+
 #if (defined(ESP32) && SOC_WIFI_SUPPORTED) || defined(ESP8266)
     // if there is no "NETWORK" providing service registered previously (before begin()),
     // register a Wi-Fi network providing service, if autoconnect is true,
@@ -163,58 +434,38 @@ void Mokosh::begin(bool autoconnect)
     if (!this->isOffline && autoconnect && !this->isServiceRegistered(MokoshService::DEPENDENCY_NETWORK))
     {
         mlogD("autoconnect, registering Wi-Fi as a network provider");
-        auto network = std::make_shared<MokoshWiFiService>();
-        this->registerService(MokoshService::DEPENDENCY_NETWORK, network);
-
-        // run immediately, before all other services
-        bool isConnected = MokoshResilience::Retry::retry([&network]()
-                                                          { return network->setup(); }, 3, 5000, 1);
-
-        if (!isConnected)
-        {
-            this->error(MokoshErrors::NetworkConnectionFailed);
-        }
+        this->registerService(MokoshService::DEPENDENCY_NETWORK, std::make_shared<MokoshWiFiService>());
 
         if (!this->isMqttUnused && !this->isServiceRegistered(MokoshService::DEPENDENCY_MQTT))
         {
             mlogD("autoconnect, registering default MQTT provider");
-            auto mqtt = std::make_shared<PubSubClientService>();
-            this->registerService(MokoshService::DEPENDENCY_MQTT, mqtt);
-
-            // run immediately, before all other services
-            bool isConnected = MokoshResilience::Retry::retry([&mqtt]()
-                                                              { return mqtt->setup(); }, 3, 5000, 1);
-
-            if (!isConnected)
-            {
-                this->error(MokoshErrors::MqttConnectionFailed);
-            }
+            this->registerService(MokoshService::DEPENDENCY_MQTT, std::make_shared<PubSubClientService>());
         }
 
-        this->hello();
+        // hello is sent when the connection is ready
+        this->helloDependency = this->isMqttUnused ? MokoshService::DEPENDENCY_NETWORK : MokoshService::DEPENDENCY_MQTT;
     }
 #else
 #warning Not ESP8266 or ESP32, autoconnect is set to false, network is not configured
     autoconnect = false;
 #endif
 
-    // set up tickers and all services
+    // set up tickers and start all services, the ones which are not ready
+    // immediately (like the network) are continued in loop()
     initializeTickers();
     this->setupServices();
 
-    mlogI("Starting operations...");
-    isAfterBegin = true;
-}
+#if MOKOSH_EXECUTOR
+    if (this->isExecutorEnabled)
+        this->startExecutor();
+#endif
 
-std::shared_ptr<MokoshMqttService> Mokosh::getMqttService()
-{
-    return this->getRegisteredService<MokoshMqttService>(MokoshService::DEPENDENCY_MQTT);
-}
+    // the services which got ready before the executor took them
+    this->updatePolledServices();
 
-std::shared_ptr<MokoshNetworkService> Mokosh::getNetworkService()
-{
-    auto network = this->getRegisteredService<MokoshNetworkService>(MokoshService::DEPENDENCY_NETWORK);
-    return network;
+    mlogI("Starting operations...");
+    isAfterBegin = true;
+    this->lastLoopTime = micros();
 }
 
 void Mokosh::publishIP()
@@ -268,7 +519,8 @@ bool Mokosh::reconnect()
 #if (defined(ESP32) && SOC_WIFI_SUPPORTED) || defined(ESP8266)
     if (!this->isOffline)
     {
-        auto network = this->getRegisteredService<MokoshWiFiService>(MokoshService::DEPENDENCY_NETWORK);
+        // the network service registered on this platform is Wi-Fi
+        MokoshWiFiService *network = static_cast<MokoshWiFiService *>(this->networkService.get());
 
         if (network == nullptr)
         {
@@ -284,6 +536,10 @@ bool Mokosh::reconnect()
             }
         }
 
+        // until it is ready, connecting is done by setting it up
+        if (network->getState() != SERVICE_READY)
+            return false;
+
         if (!network->isConnected())
         {
             if (this->isIgnoringConnectionErrors)
@@ -295,8 +551,12 @@ bool Mokosh::reconnect()
             {
                 if (this->isForceNetworkReconnect)
                 {
-                    mlogI("Network is not connected, forcing reconnect.");
-                    network->reconnect();
+                    // connecting is done by a task, it is started only once
+                    if (!network->isReconnecting())
+                    {
+                        mlogI("Network is not connected, forcing reconnect.");
+                        network->reconnect();
+                    }
                 }
                 else
                 {
@@ -306,7 +566,7 @@ bool Mokosh::reconnect()
             }
         }
 
-        auto mqtt = this->getMqttService();
+        auto &mqtt = this->getMqttService();
         if (mqtt == nullptr)
         {
             if (this->isMqttUnused)
@@ -326,6 +586,9 @@ bool Mokosh::reconnect()
             }
         }
 
+        if (mqtt->getState() != SERVICE_READY)
+            return network->isConnected();
+
         if (network->isConnected() && !mqtt->isConnected())
         {
             if (this->isForceNetworkReconnect)
@@ -361,6 +624,38 @@ Mokosh *Mokosh::setHeartbeat(bool value)
     return this;
 }
 
+Mokosh *Mokosh::setStatsInterval(unsigned long interval)
+{
+    this->statsTimer.cancel();
+
+    if (interval > 0)
+        this->statsTimer = this->registerIntervalFunction([this]()
+                                                          { this->publishStats(this->stats_topic); },
+                                                          interval);
+
+    return this;
+}
+
+Mokosh *Mokosh::setIdleMode(bool value, unsigned long maxTime)
+{
+    this->isIdleModeEnabled = value;
+    this->maxIdleTime = maxTime;
+
+#if defined(ESP32)
+    this->loopTask = xTaskGetCurrentTaskHandle();
+#endif
+
+    return this;
+}
+
+void Mokosh::wakeUp()
+{
+#if defined(ESP32)
+    if (this->loopTask != nullptr)
+        xTaskNotifyGive(this->loopTask);
+#endif
+}
+
 Mokosh *Mokosh::getInstance()
 {
     return _instance;
@@ -375,164 +670,818 @@ Mokosh *Mokosh::setLogLevel(LogLevel level)
         debug->setLevel(level);
     }
 
-    return this;
-}
-
-void Mokosh::loop()
-{
-    // updating all registered tickers
-    for (auto &ticker : tickers)
+    for (auto &debug : this->rawLoggers)
     {
-        ticker->update();
+        debug->setLevel(level);
     }
 
-    this->reconnect();
+    Mokosh::updateLogLevelCache();
 
-    for (auto &service : this->services)
-    {
-        service.second->loop();
-    }
+    return this;
 }
 
-void Mokosh::publishShortVersion()
+Mokosh *Mokosh::setLogLevel(const char *tag, LogLevel level)
 {
-    if (this->getMqttService() == nullptr)
+    uint32_t hash = MokoshHash::hash(tag);
+
+    for (int i = 0; i < Mokosh::tagLogLevelsCount; i++)
     {
-        if (this->isMqttUnused)
+        if (Mokosh::tagLogLevels[i].tag == hash)
         {
-            // MQTT is unused, do not publish
-            return;
+            Mokosh::tagLogLevels[i].level = level;
+            return this;
         }
-
-        mlogE("Cannot publish version, MQTT service is not registered.");
-        return;
     }
 
-    int sep = this->version.indexOf('+');
-
-    if (sep != -1)
+    if (Mokosh::tagLogLevelsCount >= MOKOSH_LOG_TAGS)
     {
-        String ver = this->version.substring(0, sep);
-        this->getMqttService()->publish(version_topic, ver);
-        mlogD("Version: %s", ver.c_str());
+        mlogE("Cannot set level for tag %s, too many tags", tag);
+        return this;
     }
-    else
+
+    Mokosh::tagLogLevels[Mokosh::tagLogLevelsCount].tag = hash;
+    Mokosh::tagLogLevels[Mokosh::tagLogLevelsCount].level = level;
+    Mokosh::tagLogLevelsCount++;
+
+    return this;
+}
+
+Mokosh *Mokosh::setLogRateLimit(unsigned long window)
+{
+    for (int i = 0; i <= LogLevel::ANY; i++)
     {
-        this->getMqttService()->publish(version_topic, this->version);
-        mlogD("Version: %s", this->version.c_str());
+        Mokosh::logRateLimits[i] = window;
     }
+
+    return this;
 }
 
-void Mokosh::_processCommand(String command)
+Mokosh *Mokosh::setLogRateLimit(LogLevel level, unsigned long window)
 {
-    String param = "";
-    int eq = command.indexOf('=');
-    if (eq > -1)
+    Mokosh::logRateLimits[level] = window;
+    return this;
+}
+
+Mokosh *Mokosh::resetLogLevel(const char *tag)
+{
+    uint32_t hash = MokoshHash::hash(tag);
+
+    for (int i = 0; i < Mokosh::tagLogLevelsCount; i++)
     {
-        param = command.substring(eq + 1);
-        command = command.substring(0, eq);
+        if (Mokosh::tagLogLevels[i].tag == hash)
+        {
+            Mokosh::tagLogLevelsCount--;
+            Mokosh::tagLogLevels[i] = Mokosh::tagLogLevels[Mokosh::tagLogLevelsCount];
+            break;
+        }
     }
-    mlogI("Command: %s, param %s", command.c_str(), param.c_str());
 
-    // try the built-in commands first
-    if (command == "gver" || command == "getver")
-    {
-        mlogV("Version: %s", this->version.c_str());
-        this->publishShortVersion();
+    return this;
+}
 
-        return;
-    }
+void Mokosh::loop()
+{
+    MOKOSH_PROFILE_SCOPE("loop");
 
-    if (command == "mlog")
-    {
-        mlogE("mlog REQUESTED");
+    // every phase is measured from the end of the previous one, so a single
+    // micros() call is needed for each
+    unsigned long startTime = micros();
+    unsigned long time = startTime;
 
-        return;
-    }
+    // running all tickers which are due
+    this->scheduler.update();
+    time = this->loopStats.lap(PHASE_TIMERS, time);
 
-    if (command == "getip")
-    {
-        this->publishIP();
+    // continuing the cooperative tasks which are not waiting
+    this->tasks.update();
+    time = this->loopStats.lap(PHASE_TASKS, time);
 
-        return;
-    }
+#if MOKOSH_EXECUTOR
+    // the jobs passed from the executor
+    this->executor.runPosted(16);
+    time = this->loopStats.lap(PHASE_JOBS, time);
+#endif
 
-    if (command == "getfullver")
-    {
-        mlogV("Version: %s", this->version.c_str());
+    // continuing the services which are not set up yet
+    if (this->pendingServiceCount > 0)
+        this->updateServices();
 
-        if (this->getMqttService() == nullptr)
-        {
-            if (this->isMqttUnused)
-            {
-                // MQTT is unused, do not publish
-                return;
-            }
+    time = this->loopStats.lap(PHASE_SETUP, time);
 
-            mlogE("Cannot publish version, MQTT service is not registered.");
-            return;
-        }
-        this->getMqttService()->publish(debug_response_topic, this->version);
+    this->reconnect();
+    time = this->loopStats.lap(PHASE_RECONNECT, time);
 
-        return;
-    }
+    // the lists are not recreated when a service is registered or gets
+    // ready inside loop() of another one, as they are walked then
+    if (this->isPolledServicesChanged)
+        this->updatePolledServices();
 
-#if defined(ESP32) || defined(ESP8266)
-    if (command == "gmd5")
-    {
-        char md5[128];
-        ESP.getSketchMD5().toCharArray(md5, 128);
-        mlogV("Firmware MD5: %s", md5);
+    unsigned long servicesTime = time;
+    for (auto &polled : this->polledServices)
+        time = this->runService(polled, time);
 
-        if (this->getMqttService() == nullptr)
+    // the periodic ones are checked only when the earliest one is due
+    if (!this->periodicServices.empty())
+    {
+        unsigned long now = millis();
+        if ((long)(now - this->periodicDueTime) >= 0)
         {
-            if (this->isMqttUnused)
+            unsigned long next = ULONG_MAX;
+            for (auto &polled : this->periodicServices)
             {
-                // MQTT is unused, do not publish
-                return;
+                if ((long)(now - polled.dueTime) >= 0)
+                {
+                    time = this->runService(polled, time);
+                    polled.dueTime = now + polled.interval;
+                }
+
+                next = std::min(next, polled.dueTime - now);
             }
 
-            mlogE("Cannot publish md5, MQTT service is not registered.");
-            return;
+            this->periodicDueTime = now + next;
         }
-        this->getMqttService()->publish(debug_response_topic, md5);
-
-        return;
     }
-#endif
 
-    if (command == "reboot")
-    {
+    if (this->staticServicesLoop != nullptr)
+        time = this->staticServicesLoop(this, time);
+    time = this->loopStats.lap(PHASE_SERVICES, servicesTime);
+
+    if (!Mokosh::isLogTaskRunning)
+        Mokosh::drainLogs(Mokosh::logDrainPerLoop);
+
+    time = this->loopStats.lap(PHASE_LOGS, time);
+    this->loopStats.record(time - startTime);
+
+    if (this->isIdleModeEnabled)
+        this->idle();
+}
+
+unsigned long Mokosh::runService(const PolledService &polled, unsigned long time)
+{
+#if MOKOSH_PROFILER
+    MokoshProfileScope scope(polled.profileSlot);
+#endif
+
+    polled.service->loop();
+    return this->recordService(polled.key, polled.service.get(), time);
+}
+
+unsigned long Mokosh::recordService(const char *key, MokoshService *service, unsigned long time)
+{
+    unsigned long now = micros();
+    unsigned long duration = now - time;
+
+    MokoshExecutionStats &stats = service->getExecutionStats();
+    if (stats.record(duration) && stats.consecutiveOverruns == 1)
+    {
+        mlogW("Service %s loop took %lu us, over the budget of %lu us", key, duration, stats.budget);
+        now = micros();
+    }
+
+    return now;
+}
+
+void Mokosh::updatePolledServices()
+{
+    this->isPolledServicesChanged = false;
+    this->polledServices.clear();
+    this->periodicServices.clear();
+
+    unsigned long now = millis();
+    for (auto &service : this->services)
+    {
+        // services are not run until they are set up
+        if (service.second->state != SERVICE_READY || service.second->isStatic)
+            continue;
+
+#if MOKOSH_EXECUTOR
+        if (this->executor.isRunning() && service.second->isRunOnExecutor())
+            continue;
+#endif
+
+        unsigned long interval = service.second->getPollInterval();
+        if (interval == MokoshService::POLL_NEVER)
+            continue;
+
+#if MOKOSH_PROFILER
+        // the slot is looked up once, not on every run
+        if (!service.second->isProfileSlotFound)
+        {
+            service.second->profileSlot = MokoshProfiler::find(service.first, false);
+            service.second->isProfileSlotFound = true;
+        }
+#endif
+
+        PolledService polled = {service.first, service.second, interval, now, service.second->profileSlot};
+        if (interval == 0)
+            this->polledServices.push_back(polled);
+        else
+            this->periodicServices.push_back(polled);
+    }
+
+    // the new ones are run in the next iteration
+    this->periodicDueTime = now;
+}
+
+void Mokosh::idle()
+{
+    unsigned long time = this->maxIdleTime;
+    time = std::min(time, this->scheduler.getTimeToNext());
+    time = std::min(time, this->tasks.getTimeToNext());
+
+    if (this->pendingServiceCount > 0)
+        time = std::min(time, this->setupTimeToNext);
+
+    for (auto &polled : this->polledServices)
+    {
+        time = std::min(time, polled.service->getMaxIdleTime());
+    }
+
+    if (!this->periodicServices.empty())
+    {
+        long untilDue = (long)(this->periodicDueTime - millis());
+        time = std::min(time, untilDue > 0 ? (unsigned long)untilDue : 0UL);
+
+        for (auto &polled : this->periodicServices)
+            time = std::min(time, polled.service->getMaxIdleTime());
+    }
+
+    for (auto service : this->staticServices)
+    {
+        if (service->state != SERVICE_READY)
+            continue;
+
+        // MokoshStatic checks the periodic ones only when it is woken up
+        unsigned long interval = service->getPollInterval();
+        if (interval > 0 && interval != MokoshService::POLL_NEVER)
+            time = std::min(time, interval);
+
+        time = std::min(time, service->getMaxIdleTime());
+    }
+
+    // logs waiting in the queue are passed in the next loop()
+    if (Mokosh::logQueue != nullptr && !Mokosh::isLogTaskRunning && Mokosh::logQueue->size() > 0)
+        time = 0;
+
+    // everything since the previous sleep is counted as busy time, also
+    // the code run outside of loop()
+    unsigned long now = micros();
+    this->busyTime += now - this->lastLoopTime;
+
+    if (time > 0)
+    {
+        if (this->onIdle != nullptr)
+        {
+            this->onIdle(time);
+        }
+        else
+        {
+#if defined(ESP32)
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(time));
+#else
+            // on ESP8266 with WIFI_LIGHT_SLEEP mode set, the chip sleeps
+            delay(time);
+#endif
+        }
+    }
+
+    this->lastLoopTime = micros();
+    this->idleTime += this->lastLoopTime - now;
+}
+
+void Mokosh::publishDutyCycle()
+{
+    if (this->getMqttService() == nullptr)
+    {
+        if (!this->isMqttUnused)
+            mlogE("Cannot publish duty cycle, MQTT service is not registered.");
+
+        return;
+    }
+
+    uint64_t total = this->busyTime + this->idleTime;
+    float duty = total > 0 ? 100.0 * this->busyTime / total : 100.0;
+
+    char msg[96] = {0};
+    snprintf(msg, sizeof(msg) - 1, "{\"busy\": %lu, \"idle\": %lu, \"duty\": %.1f}", (unsigned long)(this->busyTime / 1000), (unsigned long)(this->idleTime / 1000), duty);
+    this->getMqttService()->publish(debug_response_topic, msg);
+}
+
+void Mokosh::publishLoopStats()
+{
+    auto mqtt = this->getMqttService();
+    if (mqtt == nullptr)
+    {
+        if (!this->isMqttUnused)
+            mlogE("Cannot publish loop stats, MQTT service is not registered.");
+
+        return;
+    }
+
+    struct Entry
+    {
+        char name[24];
+        const MokoshExecutionStats *stats;
+        int demotion;
+    };
+
+    std::vector<Entry> entries;
+    for (auto &service : this->services)
+    {
+        Entry entry;
+        snprintf(entry.name, sizeof(entry.name), "%s", service.first);
+        entry.stats = &service.second->getExecutionStats();
+        entry.demotion = 0;
+        entries.push_back(entry);
+    }
+
+    for (size_t slot = 0; slot < this->scheduler.getCapacity(); slot++)
+    {
+        MokoshTimer timer = this->scheduler.getTimer(slot);
+        if (!timer.isActive())
+            continue;
+
+        Entry entry;
+        snprintf(entry.name, sizeof(entry.name), "timer%d", (int)slot);
+        entry.stats = timer.getExecutionStats();
+        entry.demotion = timer.getDemotion();
+        entries.push_back(entry);
+    }
+
+    // the worst offenders first
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+              {
+                  if (a.stats->overrunCount != b.stats->overrunCount)
+                      return a.stats->overrunCount > b.stats->overrunCount;
+
+                  return a.stats->maxDuration > b.stats->maxDuration; });
+
+    char msg[160];
+    for (auto &entry : entries)
+    {
+        const MokoshExecutionStats *stats = entry.stats;
+        unsigned long average = stats->count > 0 ? (unsigned long)(stats->totalDuration / stats->count) : 0;
+
+        snprintf(msg, sizeof(msg), "{\"name\": \"%s\", \"count\": %lu, \"avg\": %lu, \"max\": %lu, \"budget\": %lu, \"overruns\": %lu, \"demotion\": %d}",
+                 entry.name, (unsigned long)stats->count, average, stats->maxDuration, stats->budget, (unsigned long)stats->overrunCount, entry.demotion);
+        mqtt->publish(debug_response_topic, msg);
+    }
+}
+
+// appends the histogram as a JSON array
+static size_t printHistogram(char *buffer, size_t size, const uint32_t *histogram, int count)
+{
+    size_t length = 0;
+    for (int i = 0; i < count && length < size; i++)
+        length += snprintf(buffer + length, size - length, i == 0 ? "[%lu" : ", %lu", (unsigned long)histogram[i]);
+
+    if (length < size)
+        length += snprintf(buffer + length, size - length, "]");
+
+    return length;
+}
+
+void Mokosh::publishStats(const char *topic)
+{
+    auto mqtt = this->getMqttService();
+    if (mqtt == nullptr)
+    {
+        if (!this->isMqttUnused)
+            mlogE("Cannot publish stats, MQTT service is not registered.");
+
+        return;
+    }
+
+    static const char *phaseNames[PHASE_COUNT] = {"timers", "tasks", "jobs", "reconnect", "services", "logs", "setup"};
+
+    const MokoshLoopStats &stats = this->loopStats;
+    unsigned long average = stats.count > 0 ? (unsigned long)(stats.totalDuration / stats.count) : 0;
+
+    // a message for the loop, one for its phases and one for every service
+    // and timer, so they fit in the MQTT client buffer; CPU times are in
+    // milliseconds
+    char msg[256];
+    size_t length = snprintf(msg, sizeof(msg), "{\"loops\": %lu, \"avg\": %lu, \"max\": %lu, \"cpu\": %lu, \"hist\": ",
+                             (unsigned long)stats.count, average, stats.maxDuration, (unsigned long)(stats.totalDuration / 1000));
+    length += printHistogram(msg + length, sizeof(msg) - length, stats.histogram, MOKOSH_LOOP_HISTOGRAM_SIZE);
+    if (length < sizeof(msg))
+        snprintf(msg + length, sizeof(msg) - length, "}");
+
+    mqtt->publish(topic, msg);
+
+    length = 0;
+    for (int phase = 0; phase < PHASE_COUNT && length < sizeof(msg); phase++)
+        length += snprintf(msg + length, sizeof(msg) - length, phase == 0 ? "{\"%s\": %lu" : ", \"%s\": %lu", phaseNames[phase], (unsigned long)(stats.phaseDuration[phase] / 1000));
+    if (length < sizeof(msg))
+        snprintf(msg + length, sizeof(msg) - length, "}");
+
+    mqtt->publish(topic, msg);
+
+    for (auto &service : this->services)
+    {
+        const MokoshExecutionStats &execution = service.second->getExecutionStats();
+        snprintf(msg, sizeof(msg), "{\"service\": \"%s\", \"cpu\": %lu, \"count\": %lu}",
+                 service.first, (unsigned long)(execution.totalDuration / 1000), (unsigned long)execution.count);
+        mqtt->publish(topic, msg);
+    }
+
+    for (size_t slot = 0; slot < this->scheduler.getCapacity(); slot++)
+    {
+        MokoshTimer timer = this->scheduler.getTimer(slot);
+        const MokoshExecutionStats *execution = timer.getExecutionStats();
+        if (execution == nullptr)
+            continue;
+
+        snprintf(msg, sizeof(msg), "{\"timer\": %d, \"cpu\": %lu, \"count\": %lu}",
+                 (int)slot, (unsigned long)(execution->totalDuration / 1000), (unsigned long)execution->count);
+        mqtt->publish(topic, msg);
+    }
+}
+
+#if MOKOSH_TIMER_STATS
+void Mokosh::publishTimers()
+{
+    auto mqtt = this->getMqttService();
+    if (mqtt == nullptr)
+    {
+        if (!this->isMqttUnused)
+            mlogE("Cannot publish timers, MQTT service is not registered.");
+
+        return;
+    }
+
+    // a message for every timer, so it fits in the MQTT client buffer
+    char msg[256];
+    for (size_t slot = 0; slot < this->scheduler.getCapacity(); slot++)
+    {
+        MokoshTimer timer = this->scheduler.getTimer(slot);
+        const MokoshTimerStats *stats = timer.getStats();
+        if (stats == nullptr)
+            continue;
+
+        size_t length = snprintf(msg, sizeof(msg), "{\"timer\": %d, \"period\": %lu, \"runs\": %lu, \"missed\": %lu, \"maxlate\": %lu, \"late\": ",
+                                 (int)slot, timer.getPeriod(), (unsigned long)stats->runCount, (unsigned long)stats->missedCount, stats->maxLateness);
+        length += printHistogram(msg + length, sizeof(msg) - length, stats->lateness, MOKOSH_TIMER_HISTOGRAM_SIZE);
+        if (length < sizeof(msg))
+            length += snprintf(msg + length, sizeof(msg) - length, ", \"jitter\": ");
+        if (length < sizeof(msg))
+            length += printHistogram(msg + length, sizeof(msg) - length, stats->jitter, MOKOSH_TIMER_HISTOGRAM_SIZE);
+        if (length < sizeof(msg))
+            snprintf(msg + length, sizeof(msg) - length, "}");
+
+        mqtt->publish(debug_response_topic, msg);
+    }
+}
+#endif
+
+#if MOKOSH_PROFILER
+void Mokosh::publishProfile()
+{
+    auto mqtt = this->getMqttService();
+    if (mqtt == nullptr)
+    {
+        if (!this->isMqttUnused)
+            mlogE("Cannot publish profile, MQTT service is not registered.");
+
+        return;
+    }
+
+    // a single message must fit in the MQTT client buffer
+    char msg[224] = {0};
+    char entry[96];
+    const char *header = "{\"unit\": \"%s\", \"scopes\": {";
+    size_t length = snprintf(msg, sizeof(msg), header, MokoshProfiler::UNIT);
+    size_t headerLength = length;
+
+    for (int i = 0; i < MokoshProfiler::getCount(); i++)
+    {
+        const MokoshProfilerEntry &scope = MokoshProfiler::getEntry(i);
+        size_t entryLength = snprintf(entry, sizeof(entry), "\"%s\": {\"count\": %lu, \"total\": %.0f, \"min\": %lu, \"max\": %lu}",
+                                      scope.name, (unsigned long)scope.count, (double)scope.total,
+                                      (unsigned long)(scope.count > 0 ? scope.min : 0), (unsigned long)scope.max);
+
+        // separator, entry and the closing braces
+        if (length > headerLength && length + 2 + entryLength + 3 > sizeof(msg))
+        {
+            strcat(msg, "}}");
+            mqtt->publish(debug_response_topic, msg);
+            length = snprintf(msg, sizeof(msg), header, MokoshProfiler::UNIT);
+        }
+
+        if (length > headerLength)
+            strcat(msg, ", ");
+        strcat(msg, entry);
+        length = strlen(msg);
+    }
+
+    strcat(msg, "}}");
+    mqtt->publish(debug_response_topic, msg);
+}
+#endif
+
+void Mokosh::publishShortVersion()
+{
+    if (this->getMqttService() == nullptr)
+    {
+        if (this->isMqttUnused)
+        {
+            // MQTT is unused, do not publish
+            return;
+        }
+
+        mlogE("Cannot publish version, MQTT service is not registered.");
+        return;
+    }
+
+    int sep = this->version.indexOf('+');
+
+    if (sep != -1)
+    {
+        String ver = this->version.substring(0, sep);
+        this->getMqttService()->publish(version_topic, ver);
+        mlogD("Version: %s", ver.c_str());
+    }
+    else
+    {
+        this->getMqttService()->publish(version_topic, this->version);
+        mlogD("Version: %s", this->version.c_str());
+    }
+}
+
+void Mokosh::registerBuiltInCommands()
+{
+    auto getVersion = [this](MokoshStringView param)
+    {
+        mlogV("Version: %s", this->version.c_str());
+        this->publishShortVersion();
+    };
+    this->commands.add("gver", getVersion, "publishes the short version");
+    this->commands.add("getver", getVersion, "the same as gver");
+
+    this->commands.add(
+        "mlog", [](MokoshStringView param)
+        { mlogE("mlog REQUESTED"); },
+        "logs a test error");
+
+    this->commands.add(
+        "getip", [this](MokoshStringView param)
+        { this->publishIP(); },
+        "publishes the IP address");
+
+    this->commands.add(
+        "getfullver", [this](MokoshStringView param)
+        {
+            mlogV("Version: %s", this->version.c_str());
+
+            if (this->getMqttService() == nullptr)
+            {
+                if (this->isMqttUnused)
+                {
+                    // MQTT is unused, do not publish
+                    return;
+                }
+
+                mlogE("Cannot publish version, MQTT service is not registered.");
+                return;
+            }
+            this->getMqttService()->publish(debug_response_topic, this->version);
+        },
+        "publishes the full version");
+
+#if defined(ESP32) || defined(ESP8266)
+    this->commands.add(
+        "gmd5", [this](MokoshStringView param)
+        {
+            char md5[128];
+            ESP.getSketchMD5().toCharArray(md5, 128);
+            mlogV("Firmware MD5: %s", md5);
+
+            if (this->getMqttService() == nullptr)
+            {
+                if (this->isMqttUnused)
+                {
+                    // MQTT is unused, do not publish
+                    return;
+                }
+
+                mlogE("Cannot publish md5, MQTT service is not registered.");
+                return;
+            }
+            this->getMqttService()->publish(debug_response_topic, md5);
+        },
+        "publishes MD5 of the firmware");
+#endif
+
+    this->commands.add(
+        "reboot", [](MokoshStringView param)
+        {
 #if defined(ESP32) || defined(ESP8266)
-        ESP.restart();
+            ESP.restart();
 #elif defined(PICO_RP2040)
-        rp2040.restart();
+            rp2040.restart();
 #else
 #warning Implement restart for this platform
+#endif
+        },
+        "restarts the device");
+
+    this->commands.add(
+        "showerror", [this](MokoshStringView param)
+        {
+            long errorCode = param.toInt();
+            mlogE("Error initiated: %ld", errorCode);
+            this->error(errorCode);
+        },
+        "throws an error: showerror=code");
+
+    this->commands.add(
+        "dutycycle", [this](MokoshStringView param)
+        {
+            if (param == "reset")
+            {
+                this->busyTime = 0;
+                this->idleTime = 0;
+                this->lastLoopTime = micros();
+                return;
+            }
+
+            this->publishDutyCycle();
+        },
+        "publishes the busy and idle time, dutycycle=reset clears them");
+
+#if MOKOSH_PROFILER
+    this->commands.add(
+        "profile", [this](MokoshStringView param)
+        {
+            if (param == "reset")
+            {
+                MokoshProfiler::reset();
+                return;
+            }
+
+            this->publishProfile();
+        },
+        "publishes the profiled scopes, profile=reset clears them");
+#endif
+
+    this->commands.add(
+        "loopstats", [this](MokoshStringView param)
+        {
+            if (param == "reset")
+            {
+                for (auto &service : this->services)
+                    service.second->getExecutionStats().reset();
+
+                for (size_t slot = 0; slot < this->scheduler.getCapacity(); slot++)
+                    this->scheduler.getTimer(slot).resetExecutionStats();
+
+                return;
+            }
+
+            this->publishLoopStats();
+        },
+        "publishes execution times of the services and timers, loopstats=reset clears them");
+
+    this->commands.add(
+        "boot", [this](MokoshStringView param)
+        { this->publishBoot(); },
+        "publishes the state of the services");
+
+    this->commands.add(
+        "stats", [this](MokoshStringView param)
+        {
+            if (param == "reset")
+            {
+                this->loopStats.reset();
+
+                for (auto &service : this->services)
+                    service.second->getExecutionStats().reset();
+
+                for (size_t slot = 0; slot < this->scheduler.getCapacity(); slot++)
+                    this->scheduler.getTimer(slot).resetExecutionStats();
+
+                return;
+            }
+
+            this->publishStats(debug_response_topic);
+        },
+        "publishes the loop statistics, stats=reset clears them");
+
+#if MOKOSH_TIMER_STATS
+    this->commands.add(
+        "timers", [this](MokoshStringView param)
+        {
+            if (param == "reset")
+            {
+                for (size_t slot = 0; slot < this->scheduler.getCapacity(); slot++)
+                    this->scheduler.getTimer(slot).resetStats();
+
+                return;
+            }
+
+            this->publishTimers();
+        },
+        "publishes lateness of the timers, timers=reset clears it");
 #endif
 
+    this->commands.add(
+        "setdebuglevel", [this](MokoshStringView param)
+        {
+            // setdebuglevel=tag:level sets level only for a given tag,
+            // and setdebuglevel=tag: removes it
+            int sep = param.indexOf(':');
+            if (sep > -1)
+            {
+                char tag[32];
+                param.substring(0, sep).copyTo(tag, sizeof(tag));
+                MokoshStringView level = param.substring(sep + 1);
+
+                if (level.isEmpty())
+                    this->resetLogLevel(tag);
+                else
+                    this->setLogLevel(tag, (LogLevel)(int)level.toInt());
+
+                return;
+            }
+
+            long level = param.toInt();
+            this->setLogLevel((LogLevel)(int)level);
+        },
+        "sets the log level: setdebuglevel=level or setdebuglevel=tag:level");
+
+    this->commands.add(
+        "help", [this](MokoshStringView param)
+        { this->publishHelp(); },
+        "publishes the list of commands");
+}
+
+void Mokosh::publishHelp()
+{
+    if (this->getMqttService() == nullptr)
+    {
+        if (!this->isMqttUnused)
+            mlogE("Cannot publish help, MQTT service is not registered.");
+
         return;
     }
 
-    if (command == "showerror")
+    for (auto &command : this->commands)
     {
-        long errorCode = param.toInt();
-        mlogE("Error initiated: %ld", errorCode);
-        this->error(errorCode);
-        return;
+        char msg[192] = {0};
+        snprintf(msg, sizeof(msg) - 1, "{\"command\": \"%s\", \"help\": \"%s\"}", command.getName(), command.help != nullptr ? command.help : "");
+        this->getMqttService()->publish(debug_response_topic, msg);
     }
+}
+
+Mokosh *Mokosh::registerCommand(const char *name, MokoshCommandHandler handler, const char *help)
+{
+    this->commands.add(name, handler, help);
+    return this;
+}
 
-    if (command == "setdebuglevel")
+Mokosh *Mokosh::registerCommand(const char *name, MokoshCommandViewHandler handler, const char *help)
+{
+    this->commands.add(name, handler, help);
+    return this;
+}
+
+void Mokosh::_processCommand(String command)
+{
+    this->_processCommand(command.c_str(), command.length());
+}
+
+void Mokosh::_processCommand(const char *command, size_t length)
+{
+    // the name and the parameter are views of the received message
+    MokoshStringView name(command, length);
+    MokoshStringView param;
+    int eq = name.indexOf('=');
+    if (eq > -1)
     {
-        long level = param.toInt();
-        this->setLogLevel((LogLevel)(int)level);
+        param = name.substring(eq + 1);
+        name = name.substring(0, eq);
+    }
+    mlogI("Command: %.*s, param %.*s", (int)name.length, name.data, (int)param.length, param.data);
+
+    // the built-in and registered commands are found by hash
+    const MokoshCommand *registered = this->commands.find(name.data, name.length);
+    if (registered != nullptr)
+    {
+        // the handler is copied, as it may register or remove commands,
+        // moving the one being run
+        MokoshCommandViewHandler handler = registered->handler;
+        handler(param);
         return;
     }
 
+    // only the commands which are not registered are copied
+    String commandString = name.toString();
+    String paramString = param.toString();
+
     // now try passing to the services
     for (auto &service : this->services)
     {
-        if (service.second->command(command, param))
+        if (service.second->command(commandString, paramString))
             return;
     }
 
@@ -540,40 +1489,122 @@ void Mokosh::_processCommand(String command)
     if (this->onCommand != nullptr)
     {
         mlogD("Passing command to custom command handler");
-        this->onCommand(command, param);
+        this->onCommand(commandString, paramString);
     }
 }
 
-void Mokosh::registerIntervalFunction(fptr func, unsigned long time)
+#if MOKOSH_PROFILER
+// wraps the ticker function, so it is measured as a "tickerN" scope
+static fptr profileTicker(fptr func, size_t number)
+{
+    char name[MOKOSH_PROFILER_NAME_SIZE];
+    snprintf(name, sizeof(name), "ticker%d", (int)number);
+    int slot = MokoshProfiler::find(name, false);
+
+    return [func, slot]()
+    {
+        MokoshProfileScope scope(slot);
+        func();
+    };
+}
+#endif
+
+MokoshTimer Mokosh::registerIntervalFunction(fptr func, unsigned long time)
 {
     mlogD("Registering interval function on time %ld", time);
-    std::shared_ptr<TickTwo> ticker = std::make_shared<TickTwo>(func, time, 0, MILLIS);
-    this->tickers.push_back(ticker);
+#if MOKOSH_PROFILER
+    func = profileTicker(func, this->scheduler.getCount());
+#endif
 
     if (this->isAfterBegin)
-    {
         mlogD("Called after begin(), running ticker immediately");
-        ticker->start();
-        return;
-    }
+
+    return this->scheduler.add(func, time, 0, this->isAfterBegin);
 }
 
-void Mokosh::registerTimeoutFunction(fptr func, unsigned long time, int runs, bool start)
+MokoshTimer Mokosh::registerTimeoutFunction(fptr func, unsigned long time, int runs, bool start)
 {
     mlogD("Registering oneshot function on time %ld that will run %d times", time, runs);
-    std::shared_ptr<TickTwo> ticker = std::make_shared<TickTwo>(func, time, runs, MILLIS);
-    this->tickers.push_back(ticker);
+#if MOKOSH_PROFILER
+    func = profileTicker(func, this->scheduler.getCount());
+#endif
+
+    return this->scheduler.add(func, time, runs, start);
+}
+
+std::shared_ptr<MokoshTask> Mokosh::startTask(std::shared_ptr<MokoshTask> task)
+{
+    this->tasks.add(task);
+    return task;
+}
+
+#if MOKOSH_EXECUTOR
+Mokosh *Mokosh::setExecutor(bool value, int core)
+{
+    this->isExecutorEnabled = value;
+    this->executorCore = core;
+
+    if (this->isAfterBegin)
+    {
+        if (value)
+            this->startExecutor();
+        else
+            this->executor.stop();
+
+        this->isPolledServicesChanged = true;
+    }
+
+    return this;
+}
 
-    if (start)
+void Mokosh::startExecutor()
+{
+    if (!this->executor.start(this->executorCore))
     {
-        ticker->start();
+        mlogE("Cannot start the executor, services will run in the main loop");
         return;
     }
+
+    for (auto &service : this->services)
+    {
+        // the others are passed when they get ready
+        if (service.second->isRunOnExecutor() && service.second->state == SERVICE_READY && !service.second->isStatic)
+        {
+            mlogD("Service %s runs on the executor", service.first);
+            this->executor.addService(service.second);
+        }
+    }
+}
+
+bool Mokosh::execute(fptr job)
+{
+    return this->executor.execute(job);
+}
+#endif
+
+bool Mokosh::post(fptr job)
+{
+#if MOKOSH_EXECUTOR
+    if (this->executor.isWorker())
+        return this->executor.post(job);
+#endif
+
+    job();
+    return true;
+}
+
+bool Mokosh::isInExecutor()
+{
+#if MOKOSH_EXECUTOR
+    return this->executor.isWorker();
+#else
+    return false;
+#endif
 }
 
 void Mokosh::error(int code)
 {
-    if (this->loggers.size() == 0)
+    if (this->loggers.size() == 0 && this->rawLoggers.size() == 0)
     {
         Serial.begin(115200);
         Serial.print("Critical error: ");
@@ -591,6 +1622,7 @@ void Mokosh::error(int code)
         if (this->isRebootOnError)
         {
             mlogE("Unhandled error, code: %d, reboot imminent.", code);
+            Mokosh::flushLogs();
             delay(10000);
 #if defined(ESP32) || defined(ESP8266)
             ESP.restart();
@@ -603,6 +1635,7 @@ void Mokosh::error(int code)
         else
         {
             mlogE("Unhandled error, code: %d, going loop.", code);
+            Mokosh::flushLogs();
             // if (isWifiConnected())
             {
                 // if (this->client->connected() && this->mqtt->state() == MQTT_CONNECTED)
@@ -653,12 +1686,6 @@ String Mokosh::getMqttPrefix()
     return result;
 }
 
-bool isDependentOn(std::shared_ptr<MokoshService> service, const char *key)
-{
-    auto it = std::find(service->getDependencies().begin(), service->getDependencies().end(), key);
-    return (it != service->getDependencies().end());
-}
-
 Mokosh *Mokosh::registerService(std::shared_ptr<MokoshService> service)
 {
     const char *key = service->key();
@@ -674,17 +1701,43 @@ Mokosh *Mokosh::registerService(std::shared_ptr<MokoshService> service)
 
 Mokosh *Mokosh::registerService(const char *key, std::shared_ptr<MokoshService> service)
 {
-    this->services[key] = service;
+    // the commands of the replaced service would use it after it is gone
+    auto previous = this->services.get(key);
+    if (previous != nullptr && previous != service)
+        this->commands.removeOwnedBy(previous.get());
+
+    key = this->services.add(key, service);
+    this->isSetupOrderChanged = true;
+    service->registerCommands(this->commands);
+
+    if (strcmp(key, MokoshService::DEPENDENCY_NETWORK) == 0)
+        this->networkService = std::static_pointer_cast<MokoshNetworkService>(service);
+    else if (strcmp(key, MokoshService::DEPENDENCY_MQTT) == 0)
+        this->mqttService = std::static_pointer_cast<MokoshMqttService>(service);
 
     if (this->isAfterBegin)
     {
         mlogI("Service %s registered after begin, setting up immediately", key);
-        setupService(key, service);
+
+        // it could have replaced one being polled
+        this->isPolledServicesChanged = true;
+
+        // also the services waiting for this one
+        this->setupServices();
     }
 
     return this;
 }
 
+void Mokosh::registerStaticService(const char *key, MokoshService *service)
+{
+    service->isStatic = true;
+    this->staticServices.push_back(service);
+
+    // not owning the service, so nothing is allocated for the pointer
+    this->registerService(key, std::shared_ptr<MokoshService>(std::shared_ptr<MokoshService>(), service));
+}
+
 Mokosh *Mokosh::registerLogger(std::shared_ptr<MokoshLogger> service)
 {
     const char *key = service->key();
@@ -700,76 +1753,288 @@ Mokosh *Mokosh::registerLogger(std::shared_ptr<MokoshLogger> service)
 
 Mokosh *Mokosh::registerLogger(const char *key, std::shared_ptr<MokoshLogger> service)
 {
+    auto previous = this->services.get(key);
+    if (previous != nullptr && previous != service)
+        this->commands.removeOwnedBy(previous.get());
+
     // adding both to the services list as well as special list of only debug adapters
-    this->services[key] = service;
+    key = this->services.add(key, service);
+    this->isSetupOrderChanged = true;
+    service->registerCommands(this->commands);
 
     if (this->isAfterBegin)
     {
         mlogI("Debug Adapter %s registered after begin, setting up immediately", key);
-        setupService(key, service);
+        this->isPolledServicesChanged = true;
+        this->setupServices();
     }
 
-    Mokosh::loggers.push_back(service);
+    if (service->isFormatting())
+        Mokosh::loggers.push_back(service);
+    else
+        Mokosh::rawLoggers.push_back(service);
+
+    Mokosh::updateLogLevelCache();
 
     return this;
 }
 
+bool Mokosh::areDependenciesReady(const char *key, const std::vector<const char *> &dependencies)
+{
+    for (auto &dependency : dependencies)
+    {
+        auto other = this->services.get(dependency);
+        if (other == nullptr)
+        {
+            mlogD("Service %s is waiting for %s, which is not registered", key, dependency);
+            return false;
+        }
+
+        if (other->state != SERVICE_READY)
+            return false;
+    }
+
+    return true;
+}
+
 bool Mokosh::setupService(const char *key, std::shared_ptr<MokoshService> service)
 {
-    // auto network = this->getNetworkService();
-    // auto mqtt = this->getRegisteredService<MokoshMqttService>(MokoshService::DEPENDENCY_MQTT);
-    bool isNetwork = this->isServiceRegistered(MokoshService::DEPENDENCY_NETWORK);
-    bool isMqtt = this->isServiceRegistered(MokoshService::DEPENDENCY_MQTT);
+    // services are not being setup more than once
+    if (service->state == SERVICE_READY)
+        return true;
 
-    if (isDependentOn(service, MokoshService::DEPENDENCY_NETWORK) && !isNetwork)
+    // the dependencies of the registered services are cached
+    std::vector<const char *> uncached;
+    int i = this->services.indexOf(key);
+    if (i == -1)
+        uncached = service->getDependencies();
+
+    if (!this->areDependenciesReady(key, i != -1 ? this->services.getDependencies(i) : uncached))
     {
-        mlogE("Network dependent service %s cannot be set up because Network is not configured", key);
+        mlogE("Cannot set up service %s, its dependencies are not ready", key);
         return false;
     }
 
-    if (isDependentOn(service, MokoshService::DEPENDENCY_MQTT) && (!isNetwork || !isMqtt))
-    {
-        mlogE("MQTT dependent service %s cannot be set up because Network or MQTT are not configured", key);
+    if (service->setupAttempts++ == 0)
+        service->startTime = millis() - this->beginTime;
+
+    if (!service->setup())
         return false;
+
+    this->setServiceReady(key, service.get());
+    return true;
+}
+
+void Mokosh::setServiceReady(const char *key, MokoshService *service)
+{
+    service->state = SERVICE_READY;
+    service->readyTime = millis() - this->beginTime;
+
+    // not every service marks it by itself
+    service->setupFinished = true;
+
+    mlogI("Service %s is ready after %lu ms", key, service->readyTime);
+
+#if MOKOSH_EXECUTOR
+    if (this->executor.isRunning() && service->isRunOnExecutor() && !service->isStatic)
+    {
+        auto entry = this->services.get(key);
+        if (entry != nullptr)
+            this->executor.addService(entry);
+    }
+#endif
+
+    this->isPolledServicesChanged = true;
+
+    if (this->helloDependency != nullptr && strcmp(key, this->helloDependency) == 0)
+    {
+        this->helloDependency = nullptr;
+        this->hello();
+    }
+}
+
+void Mokosh::setServiceFailed(const char *key, MokoshService *service)
+{
+    unsigned long now = millis();
+
+    bool isNetwork = strcmp(key, MokoshService::DEPENDENCY_NETWORK) == 0;
+    bool isMqtt = strcmp(key, MokoshService::DEPENDENCY_MQTT) == 0;
+
+    // the delay grows twice with every failed attempt, up to the maximum
+    unsigned long delay = MOKOSH_SETUP_RETRY_INTERVAL;
+    for (int i = 1; i < service->setupAttempts && delay < MOKOSH_SETUP_RETRY_MAX_INTERVAL; i++)
+        delay *= 2;
+
+    delay = std::min(delay, (unsigned long)MOKOSH_SETUP_RETRY_MAX_INTERVAL);
+
+    service->state = SERVICE_BACKOFF;
+    service->retryTime = now + delay;
+    mlogW("Service %s cannot be set up (attempt %d), retrying in %lu ms", key, service->setupAttempts, delay);
+
+    // the built-in connections were treated as fatal errors when failed
+    // in begin(), and still are, if the handler lets them to be retried
+    if (service->setupAttempts == MOKOSH_CONNECTION_ATTEMPTS)
+    {
+        if (isNetwork)
+            this->error(MokoshErrors::NetworkConnectionFailed);
+        else if (isMqtt)
+            this->error(MokoshErrors::MqttConnectionFailed);
+    }
+}
+
+size_t Mokosh::updateServices()
+{
+    // a service being set up may register another one, the order is not
+    // changed while it is walked then
+    if (this->isUpdatingServices)
+    {
+        this->areServicesChanged = true;
+        return this->pendingServiceCount;
+    }
+
+    this->isUpdatingServices = true;
+
+    if (this->isSetupOrderChanged)
+    {
+        std::vector<int> cyclic;
+        this->setupOrder = this->services.sort(cyclic);
+        this->isSetupOrderChanged = false;
+
+        // the ones not in a cycle anymore are set up as the new ones
+        for (int i : this->cyclicServices)
+        {
+            MokoshService *service = this->services.at(i).second.get();
+            if (service->state == SERVICE_FAILED && std::find(cyclic.begin(), cyclic.end(), i) == cyclic.end())
+            {
+                service->state = SERVICE_REGISTERED;
+                service->setupAttempts = 0;
+            }
+        }
+
+        for (int i : cyclic)
+        {
+            const MokoshServiceEntry &entry = this->services.at(i);
+            if (entry.second->state == SERVICE_FAILED)
+                continue;
+
+            mlogE("Service %s cannot be set up, its dependencies form a cycle", entry.first);
+            entry.second->state = SERVICE_FAILED;
+        }
+
+        this->cyclicServices = cyclic;
     }
 
-    // here should be some kind of dependency graph resolution
-    for (auto &deps : service->getDependencies())
+    size_t pending = 0;
+    this->setupTimeToNext = ULONG_MAX;
+
+    // the services are walked in the dependency order, so the dependent
+    // ones can start in the same pass as their dependencies get ready
+    for (int i : this->setupOrder)
     {
-        // built-in network and MQTT services are ignored
-        if (strcmp(deps, MokoshService::DEPENDENCY_NETWORK) == 0)
+        // the entry is not kept, registering a service may move it, and the
+        // service is kept alive even if it is replaced meanwhile
+        const char *key = this->services.at(i).first;
+        std::shared_ptr<MokoshService> service = this->services.at(i).second;
+
+        if (service->state == SERVICE_READY || service->state == SERVICE_FAILED)
             continue;
 
-        if (strcmp(deps, MokoshService::DEPENDENCY_MQTT) == 0)
+        unsigned long now = millis();
+        if (service->state == SERVICE_BACKOFF && (long)(now - service->retryTime) < 0)
+        {
+            this->setupTimeToNext = std::min(this->setupTimeToNext, service->retryTime - now);
+            pending++;
             continue;
+        }
 
-        if (this->services.find(deps) == this->services.end())
+        if (service->state != SERVICE_STARTING)
         {
-            mlogE("Cannot setup service %s because the dependency %s is not set up yet.", key, deps);
-            return false;
+            // the dependencies wake this one up when they get ready
+            if (!this->areDependenciesReady(key, this->services.getDependencies(i)))
+            {
+                pending++;
+                continue;
+            }
+
+            if (service->setupAttempts++ == 0)
+                service->startTime = now - this->beginTime;
+
+            mlogD("Starting service %s", key);
+            service->state = SERVICE_STARTING;
         }
+
+        SetupResult result = service->setupAsync();
+        if (result == SETUP_DONE)
+        {
+            this->setServiceReady(key, service.get());
+            continue;
+        }
+
+        if (result == SETUP_PENDING)
+            this->setupTimeToNext = std::min(this->setupTimeToNext, (unsigned long)MOKOSH_TASK_POLL_TIME);
+        else
+            this->setServiceFailed(key, service.get());
+
+        pending++;
     }
 
-    // services are not being setup more than once
-    if (!service->isSetup())
-        if (!service->setup())
-            return false;
+    this->isUpdatingServices = false;
 
-    return true;
+    // the services registered meanwhile are set up in the next loop()
+    if (this->areServicesChanged)
+    {
+        this->areServicesChanged = false;
+        this->setupTimeToNext = 0;
+        pending = this->services.size();
+    }
+
+    if (pending == 0 && this->pendingServiceCount > 0 && this->bootTime == 0)
+    {
+        this->bootTime = millis() - this->beginTime;
+        mlogI("All services are ready after %lu ms", this->bootTime);
+    }
+
+    this->pendingServiceCount = pending;
+    return pending;
 }
 
 void Mokosh::setupServices()
 {
-    for (auto &service : this->services)
+    // remembers there is work, so all-ready time is logged
+    this->pendingServiceCount = this->services.size();
+    this->updateServices();
+}
+
+void Mokosh::publishBoot()
+{
+    auto mqtt = this->getMqttService();
+    if (mqtt == nullptr)
+    {
+        if (!this->isMqttUnused)
+            mlogE("Cannot publish boot timeline, MQTT service is not registered.");
+
+        return;
+    }
+
+    static const char *stateNames[] = {"registered", "starting", "ready", "failed", "backoff"};
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "{\"pending\": %d, \"ready\": %lu}", (int)this->pendingServiceCount, this->bootTime);
+    mqtt->publish(debug_response_topic, msg);
+
+    // a message for every service, in the order they are set up
+    for (int i : this->setupOrder)
     {
-        auto key = service.first;
-        auto value = service.second;
+        const MokoshServiceEntry &entry = this->services.at(i);
+        MokoshService *service = entry.second.get();
 
-        setupService(key, value);
+        snprintf(msg, sizeof(msg), "{\"service\": \"%s\", \"state\": \"%s\", \"attempts\": %d, \"start\": %lu, \"ready\": %lu}",
+                 entry.first, stateNames[service->state], (int)service->setupAttempts, service->startTime, service->readyTime);
+        mqtt->publish(debug_response_topic, msg);
     }
 }
 
 bool Mokosh::isServiceRegistered(const char *key)
 {
-    return this->services.find(key) != this->services.end();
+    return this->services.contains(key);
 }
\ No newline at end of file
@@ -2,15 +2,25 @@
 
 #define MOKOSH
 
-#include <TickTwo.h>
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <type_traits>
 
 #include "MokoshConfig.hpp"
 #include "MokoshHandlers.hpp"
 #include "MokoshService.hpp"
+#include "MokoshServiceRegistry.hpp"
+#include "MokoshCommandRegistry.hpp"
 #include "MokoshLogger.hpp"
+#include "MokoshLogQueue.hpp"
+#include "MokoshHash.hpp"
+#include "MokoshProfiler.hpp"
+#include "MokoshFormat.hpp"
+#include "MokoshScheduler.hpp"
+#include "MokoshTask.hpp"
+#include "MokoshExecutor.hpp"
+#include "MokoshLoopStats.hpp"
 
 #if defined(USE_TINYUSB)
 #include <Adafruit_TinyUSB.h> // for Serial on NRF52
@@ -22,11 +32,136 @@
 #define SECONDS 1000
 #define HOURS 360000
 
-#define mlogD(fmt, ...) Mokosh::log(LogLevel::DEBUG, __func__, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define mlogV(fmt, ...) Mokosh::log(LogLevel::VERBOSE, __func__, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define mlogI(fmt, ...) Mokosh::log(LogLevel::INFO, __func__, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define mlogW(fmt, ...) Mokosh::log(LogLevel::WARNING, __func__, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
-#define mlogE(fmt, ...) Mokosh::log(LogLevel::ERROR, __func__, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+// the delay (in milliseconds) before setting up a service is retried after
+// the first failure, doubled after every next one, up to the maximum
+#if !defined(MOKOSH_SETUP_RETRY_INTERVAL)
+#define MOKOSH_SETUP_RETRY_INTERVAL 5000
+#endif
+
+#if !defined(MOKOSH_SETUP_RETRY_MAX_INTERVAL)
+#define MOKOSH_SETUP_RETRY_MAX_INTERVAL 60000
+#endif
+
+// maximum length of a command received by MQTT, longer ones are ignored;
+// it is copied to a buffer of this size on the stack and handled there
+#if !defined(MOKOSH_COMMAND_SIZE)
+#define MOKOSH_COMMAND_SIZE 128
+#endif
+
+// after how many failed attempts to set up the network or MQTT an error is
+// thrown
+#if !defined(MOKOSH_CONNECTION_ATTEMPTS)
+#define MOKOSH_CONNECTION_ATTEMPTS 3
+#endif
+
+// the lowest log level which is compiled in, mlog macros for levels below
+// are removed completely, including evaluation of their arguments
+// e.g. -DMOKOSH_LOG_MIN_LEVEL=3 leaves only mlogI, mlogW and mlogE
+#if !defined(MOKOSH_LOG_MIN_LEVEL)
+#define MOKOSH_LOG_MIN_LEVEL 0
+#endif
+
+// tag of the log messages, for which a separate level can be set, by default
+// it is the name of the source file, e.g. "PubSubClientService.hpp", to use
+// a custom one in a file, #undef MOKOSH_LOG_TAG and #define it again
+#if !defined(MOKOSH_LOG_TAG)
+#define MOKOSH_LOG_TAG MokoshHash::basename(__FILE__)
+#endif
+
+// hash of the tag, always calculated during compilation
+#define MOKOSH_LOG_TAG_ID (std::integral_constant<uint32_t, MokoshHash::fnv1a(MOKOSH_LOG_TAG)>::value)
+
+// how many tags may have their own level set
+#if !defined(MOKOSH_LOG_TAGS)
+#define MOKOSH_LOG_TAGS 8
+#endif
+
+// if enabled, every mlog call has its own state, used to suppress
+// identical messages repeated within the rate limit window
+#if !defined(MOKOSH_LOG_RATE_LIMIT)
+#define MOKOSH_LOG_RATE_LIMIT 1
+#endif
+
+// default rate limit windows in milliseconds, for errors and for other
+// levels, errors are suppressed for longer; 0 disables suppressing
+#if !defined(MOKOSH_LOG_RATE_LIMIT_WINDOW)
+#define MOKOSH_LOG_RATE_LIMIT_WINDOW 1000
+#endif
+
+#if !defined(MOKOSH_LOG_RATE_LIMIT_ERROR_WINDOW)
+#define MOKOSH_LOG_RATE_LIMIT_ERROR_WINDOW 5000
+#endif
+
+#if MOKOSH_LOG_RATE_LIMIT
+#define MOKOSH_LOG_SITE_DECL static MokoshLogSite _mokosh_log_site;
+#define MOKOSH_LOG_SITE (&_mokosh_log_site)
+#else
+#define MOKOSH_LOG_SITE_DECL
+#define MOKOSH_LOG_SITE nullptr
+#endif
+
+// the source file name in log messages is computed during compilation,
+// without the path, and only the name is stored in flash; with
+// MOKOSH_LOG_FILE_IDS defined, a short hash of the name is used instead
+#if defined(MOKOSH_LOG_FILE_IDS) && __cplusplus >= 201402L
+#define MOKOSH_LOG_FILE_DECL                                                                                             \
+    static constexpr auto _mokosh_log_file_name = MokoshHash::fileId(MokoshHash::fnv1a(MokoshHash::basename(__FILE__))); \
+    static constexpr const char *_mokosh_log_file = _mokosh_log_file_name.value;
+#elif defined(__FILE_NAME__)
+#define MOKOSH_LOG_FILE_DECL static constexpr const char *_mokosh_log_file = __FILE_NAME__;
+#elif __cplusplus >= 201402L
+#define MOKOSH_LOG_FILE_DECL                                                                                                                                       \
+    static constexpr auto _mokosh_log_file_name = MokoshHash::copyString<sizeof(__FILE__) - MokoshHash::basenameOffset(__FILE__)>(MokoshHash::basename(__FILE__)); \
+    static constexpr const char *_mokosh_log_file = _mokosh_log_file_name.value;
+#else
+#define MOKOSH_LOG_FILE_DECL static constexpr const char *_mokosh_log_file = MokoshHash::basename(__FILE__);
+#endif
+
+#define MOKOSH_LOG(level, fmt, ...)                                                                                       \
+    do                                                                                                                    \
+    {                                                                                                                     \
+        MOKOSH_LOG_SITE_DECL                                                                                              \
+        MOKOSH_LOG_FILE_DECL                                                                                              \
+        Mokosh::log(level, MOKOSH_LOG_TAG_ID, MOKOSH_LOG_SITE, __func__, _mokosh_log_file, __LINE__, fmt, ##__VA_ARGS__); \
+    } while (0)
+
+#if MOKOSH_LOG_MIN_LEVEL <= 1
+#define mlogD(fmt, ...) MOKOSH_LOG(LogLevel::DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define mlogD(fmt, ...) ((void)0)
+#endif
+
+#if MOKOSH_LOG_MIN_LEVEL <= 2
+#define mlogV(fmt, ...) MOKOSH_LOG(LogLevel::VERBOSE, fmt, ##__VA_ARGS__)
+#else
+#define mlogV(fmt, ...) ((void)0)
+#endif
+
+#if MOKOSH_LOG_MIN_LEVEL <= 3
+#define mlogI(fmt, ...) MOKOSH_LOG(LogLevel::INFO, fmt, ##__VA_ARGS__)
+#else
+#define mlogI(fmt, ...) ((void)0)
+#endif
+
+#if MOKOSH_LOG_MIN_LEVEL <= 4
+#define mlogW(fmt, ...) MOKOSH_LOG(LogLevel::WARNING, fmt, ##__VA_ARGS__)
+#else
+#define mlogW(fmt, ...) ((void)0)
+#endif
+
+#if MOKOSH_LOG_MIN_LEVEL <= 5
+#define mlogE(fmt, ...) MOKOSH_LOG(LogLevel::ERROR, fmt, ##__VA_ARGS__)
+#else
+#define mlogE(fmt, ...) ((void)0)
+#endif
+
+// state of a single mlog call, used for suppressing repeated messages
+struct MokoshLogSite
+{
+    unsigned long lastTime;
+    uint32_t lastHash;
+    uint16_t suppressed;
+};
 
 enum MokoshErrors
 {
@@ -54,6 +189,13 @@ public:
     // sets debug level verbosity, must be called before begin()
     Mokosh *setLogLevel(LogLevel level);
 
+    // sets debug level verbosity for messages with a given tag (by default
+    // the name of the source file), regardless of the levels of the loggers
+    Mokosh *setLogLevel(const char *tag, LogLevel level);
+
+    // removes the debug level set for a given tag
+    Mokosh *resetLogLevel(const char *tag);
+
     // starts Mokosh system, connects to the Wi-Fi and MQTT
     // using the provided device prefix, sets up all registered services
     void begin(bool autoconnect = true);
@@ -80,6 +222,45 @@ public:
     // use rather mlog() macros instead of direct usage of this function
     static void log(LogLevel level, const char *func, const char *file, int line, const char *fmt, ...);
 
+    // prints message with a given tag hash, used by mlog() macros, if site
+    // is not null, repeated messages from it are suppressed
+    static void log(LogLevel level, uint32_t tag, MokoshLogSite *site, const char *func, const char *file, int line, const char *fmt, ...);
+
+    // prints message with a given tag hash and a list of arguments
+    static void vlog(LogLevel level, uint32_t tag, MokoshLogSite *site, const char *func, const char *file, int line, const char *fmt, va_list args);
+
+    // sets the window in milliseconds, in which identical messages from the
+    // same mlog call are suppressed and only counted, for all levels
+    // 0 disables suppressing
+    Mokosh *setLogRateLimit(unsigned long window);
+
+    // sets the suppressing window for a given level
+    Mokosh *setLogRateLimit(LogLevel level, unsigned long window);
+
+    // recalculates the lowest level accepted by any of the registered loggers,
+    // messages below it are dropped before formatting
+    // called by setLogLevel() and registerLogger(), must be called manually
+    // if the level of a logger is changed directly
+    static void updateLogLevelCache();
+
+    // enables asynchronous logging: mlog macros only copy the message into
+    // a queue of a given capacity (rounded up to a power of two) and the
+    // loggers are run later, from loop() (at most drainPerLoop messages per
+    // iteration) or, on ESP32 if useTask is true, from a dedicated FreeRTOS
+    // task
+    Mokosh *setAsyncLogging(size_t capacity, LogOverflowPolicy policy = LogOverflowPolicy::DROP_OLDEST, int drainPerLoop = 8, bool useTask = false);
+
+    // passes at most max messages waiting in the asynchronous log queue
+    // to the loggers, returns how many were passed
+    static int drainLogs(int max);
+
+    // passes all messages waiting in the asynchronous log queue to the loggers
+    static void flushLogs();
+
+    // returns number of messages dropped because the asynchronous log
+    // queue was full
+    static uint32_t getDroppedLogCount();
+
     // prints to the loggers the "busy" indicator
     static void debug_ticker_step();
     static void debug_ticker_finish(bool success);
@@ -88,6 +269,21 @@ public:
     // an inifinite loop instead
     Mokosh *setRebootOnError(bool value);
 
+    // registers a command handled by a given function, with optional help
+    // text listed by the help command, replacing the one registered under
+    // the same name (also a built-in one)
+    Mokosh *registerCommand(const char *name, MokoshCommandHandler handler, const char *help = nullptr);
+
+    // registers a command getting a view of the parameter in the received
+    // message, which is handled without allocating
+    Mokosh *registerCommand(const char *name, MokoshCommandViewHandler handler, const char *help = nullptr);
+
+    // returns the registered commands
+    const MokoshCommandRegistry &getCommands()
+    {
+        return this->commands;
+    }
+
     // defines callback to be run when command not handled by internal
     // means is received
     THandlerFunction_Command onCommand;
@@ -96,11 +292,17 @@ public:
     // must be set before begin()
     THandlerFunction_MokoshError onError;
 
+    // defines callback to be run instead of the default sleep in the idle
+    // mode, with the time in milliseconds, e.g. to use other power saving
+    // modes or a fake clock in tests
+    THandlerFunction_Idle onIdle;
+
     // defines callback function func to be run on a specific time interval
-    // Mokosh will automatically fire the function when time (in milliseconds)
-    // occurs since the last run
-    // you can also use TickTwo manually, by accessing vector tickers
-    void registerIntervalFunction(fptr func, unsigned long time);
+    // Mokosh will automatically fire the function every time (in milliseconds),
+    // at a fixed rate, counted from the start of the timer
+    // returns a handle, which can be used to cancel, pause or change
+    // the period of the timer
+    MokoshTimer registerIntervalFunction(fptr func, unsigned long time);
 
     // throws an error of a given code
     void error(int code);
@@ -126,6 +328,9 @@ public:
     // the name of subtopic used for heartbeat messages
     const char *heartbeat_topic = "debug/heartbeat";
 
+    // the name of subtopic used for periodic loop statistics
+    const char *stats_topic = "debug/stats";
+
     // this is a PRIVATE function, should not be used from the external code
     // exposed only as a workaround
     void _mqttCommandReceived(char *topic, uint8_t *message, unsigned int length);
@@ -133,6 +338,11 @@ public:
     // this is a PRIVATE function, exposed only as a workaround
     void _processCommand(String command);
 
+    // this is a PRIVATE function, exposed only as a workaround, handles
+    // a command in a buffer which does not have to be null-terminated, but
+    // must not change until it is handled
+    void _processCommand(const char *command, size_t length);
+
     // handlers for additional events
     MokoshEvents events;
 
@@ -154,6 +364,24 @@ public:
     // sets if the heartbeat messages should be send
     Mokosh *setHeartbeat(bool value);
 
+    // sets if the idle mode is enabled, in which at the end of loop() Mokosh
+    // sleeps until the next timer is due, but no longer than maxTime and than
+    // the services allow; on ESP32 the sleep is interrupted by Wi-Fi events
+    Mokosh *setIdleMode(bool value, unsigned long maxTime = 1000);
+
+    // interrupts the sleep in the idle mode, can be called from other tasks
+    void wakeUp();
+
+    // sets how often (in milliseconds) the loop statistics are published on
+    // stats_topic, 0 disables it (default)
+    Mokosh *setStatsInterval(unsigned long interval);
+
+    // returns the duration statistics of loop()
+    const MokoshLoopStats &getLoopStats()
+    {
+        return this->loopStats;
+    }
+
     // sets if the IP message on hello should be retained
     // e.g. on Scaleway retained flag forces disconnect of the client
     Mokosh *setIPRetained(bool value);
@@ -166,11 +394,17 @@ public:
     // is being automatically run on begin() if autoconnect is true
     void setupMqttClient();
 
-    // returns an instance of the networking service
-    std::shared_ptr<MokoshNetworkService> getNetworkService();
+    // returns an instance of the networking service, cached on registration
+    const std::shared_ptr<MokoshNetworkService> &getNetworkService()
+    {
+        return this->networkService;
+    }
 
-    // returns an instance of the networking service
-    std::shared_ptr<MokoshMqttService> getMqttService();
+    // returns an instance of the MQTT service, cached on registration
+    const std::shared_ptr<MokoshMqttService> &getMqttService()
+    {
+        return this->mqttService;
+    }
 
     // a configuration object to set and read configs
     std::shared_ptr<MokoshConfig> config;
@@ -187,21 +421,47 @@ public:
     // returns prefix and hostname combination which are used for device ident
     String getHostNameWithPrefix();
 
-    // vector of tickers, functions run on the given interval
-    std::vector<std::shared_ptr<TickTwo>> getTickers();
+    // returns the scheduler running interval and timeout functions
+    MokoshScheduler &getScheduler();
 
     // registers a function that will run in a timeout, be default it will be run
-    // one time (one-shot), and time tracking starts immediately
-    void registerTimeoutFunction(fptr func, unsigned long time, int runs = 1, bool start = true);
+    // one time (one-shot), and time tracking starts immediately; the timer is
+    // removed after its last run, returns its handle
+    MokoshTimer registerTimeoutFunction(fptr func, unsigned long time, int runs = 1, bool start = true);
+
+    // starts a cooperative task, which is run by loop() until it finishes,
+    // returns the task
+    std::shared_ptr<MokoshTask> startTask(std::shared_ptr<MokoshTask> task);
+
+#if MOKOSH_EXECUTOR
+    // sets if the executor is enabled: loop() of the services which allow it
+    // is run by a worker, on ESP32 a task pinned to a given core (the Arduino
+    // loop runs on core 1), elsewhere a thread
+    Mokosh *setExecutor(bool value, int core = 0);
+
+    // runs the job on the executor, or immediately if it is not enabled,
+    // returns false if the queue is full; must be called from the main loop
+    bool execute(fptr job);
+#endif
+
+    // runs the job in the main loop, used by the code run by the executor
+    // to access what is not thread-safe; if called outside the executor,
+    // the job is run immediately; returns false if the queue is full
+    bool post(fptr job);
+
+    // returns if called from the executor worker
+    bool isInExecutor();
 
     // returns a version string registered and published everywhere
     String getVersion();
 
-    // sets up all registered services
+    // starts setting up all registered services, after the ones they
+    // depend on get ready; the ones which are not ready immediately are
+    // continued by loop(), and the failed ones are retried after a backoff
     // will be run automatically during begin()
     void setupServices();
 
-    // sets up a single service with dependency resolution
+    // sets up a single service, blocking, if all its dependencies are ready
     bool setupService(const char *key, std::shared_ptr<MokoshService> service);
 
     // checks if the service with a given name is registered
@@ -212,8 +472,9 @@ public:
     template <typename T>
     std::shared_ptr<T> getRegisteredService(const char *key)
     {
-        if (this->isServiceRegistered(key))
-            return std::static_pointer_cast<T>(this->services[key]);
+        auto service = this->services.get(key);
+        if (service != nullptr)
+            return std::static_pointer_cast<T>(service);
         else
         {
             // hack: do not show warnings for internal services
@@ -229,12 +490,29 @@ public:
         }
     }
 
-    // returns all registered services
-    std::map<const char *, std::shared_ptr<MokoshService>> getRegisteredServices()
+    // returns all registered services, in the order of registration
+    const MokoshServiceRegistry &getRegisteredServices()
     {
-        return services;
+        return this->services;
     }
 
+protected:
+    // runs loop() of the services composed at compile time by MokoshStatic,
+    // gets the time the phase started and returns the time it ended
+    typedef unsigned long (*StaticServicesLoop)(Mokosh *mokosh, unsigned long time);
+    StaticServicesLoop staticServicesLoop = nullptr;
+
+    // registers a service owned by the caller, which is set up as the others,
+    // but run by staticServicesLoop instead of being polled
+    void registerStaticService(const char *key, MokoshService *service);
+
+    // records execution time of loop() of the service, which was run since
+    // the given time, returns the time it ended
+    unsigned long recordService(const char *key, MokoshService *service, unsigned long time);
+
+    // hello is sent when the service with this key gets ready
+    const char *helloDependency = nullptr;
+
 private:
     String hostName;
     String prefix;
@@ -247,6 +525,7 @@ private:
     bool isIgnoringConnectionErrors = false;
     bool isForceNetworkReconnect = true;
     bool isHeartbeatEnabled = true;
+    bool isIdleModeEnabled = false;
     bool isAfterBegin = false;
     bool isIPRetained = true;
     bool isOffline = false;
@@ -260,13 +539,190 @@ private:
     void publishShortVersion();
     void publishIP();
 
+#if MOKOSH_PROFILER
+    // publishes the profiler statistics as JSON on debug_response_topic,
+    // split into several messages if they do not fit in a single one
+    void publishProfile();
+#endif
+
     // initialization of tickers, is called automatically by begin()
     void initializeTickers();
 
-    std::vector<std::shared_ptr<TickTwo>> tickers;
-    std::map<const char *, std::shared_ptr<MokoshService>> services;
+    MokoshScheduler scheduler;
+
+    MokoshTaskRunner tasks;
+
+#if MOKOSH_EXECUTOR
+    MokoshExecutor executor;
+    bool isExecutorEnabled = false;
+    int executorCore = 0;
+
+    // starts the executor and passes it the services which allow it
+    void startExecutor();
+#endif
+
+    // the longest sleep in the idle mode
+    unsigned long maxIdleTime = 1000;
+
+    // time spent in and out of the idle sleep since the statistics reset,
+    // in microseconds
+    uint64_t busyTime = 0;
+    uint64_t idleTime = 0;
+    unsigned long lastLoopTime = 0;
+
+#if defined(ESP32)
+    // the task running loop(), woken up by wakeUp()
+    TaskHandle_t loopTask = nullptr;
+#endif
+
+    // sleeps until the next timer is due, used in the idle mode
+    void idle();
+
+    // duration histogram and time spent in the phases of loop()
+    MokoshLoopStats loopStats;
+
+    // publishes loopStats periodically, if enabled
+    MokoshTimer statsTimer;
+
+    // publishes the time spent in and out of the idle sleep on
+    // debug_response_topic
+    void publishDutyCycle();
+
+    // publishes the execution time statistics of the service loops and
+    // timer functions on debug_response_topic, a message for every one, the
+    // ones with the most overruns and the longest runs first
+    void publishLoopStats();
+
+    // publishes the loop duration histogram and the CPU time spent in the
+    // phases of the loop, the services and the timers on a given topic
+    void publishStats(const char *topic);
+
+#if MOKOSH_TIMER_STATS
+    // publishes the lateness and jitter histograms of the timers on
+    // debug_response_topic, a message for every timer
+    void publishTimers();
+#endif
+    MokoshServiceRegistry services;
+
+    // the commands of Mokosh and the services
+    MokoshCommandRegistry commands;
+
+    // registers the built-in commands
+    void registerBuiltInCommands();
+
+    // publishes the registered commands with their help texts on
+    // debug_response_topic, a message for every command
+    void publishHelp();
+
+    // positions of the services in the registry, in the order they are set
+    // up, and if it has to be computed again, as a service was added or
+    // replaced, possibly with different dependencies
+    std::vector<int> setupOrder;
+    bool isSetupOrderChanged = true;
+
+    // positions of the services failed because of a cycle of dependencies,
+    // they are set up again if replacing a service has broken the cycle
+    std::vector<int> cyclicServices;
+
+    // number of services which are not ready or failed yet, and time in
+    // milliseconds after which they should be continued
+    size_t pendingServiceCount = 0;
+    unsigned long setupTimeToNext = ULONG_MAX;
+
+    // updateServices() is running, so the services registered meanwhile are
+    // only marked as changed and set up in the next pass
+    bool isUpdatingServices = false;
+    bool areServicesChanged = false;
+
+    // time of begin(), and time since it when all services got ready,
+    // in milliseconds
+    unsigned long beginTime = 0;
+    unsigned long bootTime = 0;
+
+    // moves forward the lifecycle of the services which are not ready yet,
+    // in the dependency order, returns how many of them are still pending
+    size_t updateServices();
+
+    // returns if all the dependencies of a service are ready
+    bool areDependenciesReady(const char *key, const std::vector<const char *> &dependencies);
+
+    // marks the service ready and runs what waits for it
+    void setServiceReady(const char *key, MokoshService *service);
+
+    // puts the service in the backoff after a failed attempt to set it up
+    void setServiceFailed(const char *key, MokoshService *service);
+
+    // publishes the state of the services and when they got ready on
+    // debug_response_topic, a message for every service
+    void publishBoot();
+
+    // a ready service run by loop(), interval and the next run time in
+    // milliseconds, the latter only for the periodic ones; the service is
+    // kept alive until the list is recreated, even if it is replaced
+    struct PolledService
+    {
+        const char *key;
+        std::shared_ptr<MokoshService> service;
+        unsigned long interval;
+        unsigned long dueTime;
+        int profileSlot;
+    };
+
+    // the services run in every iteration, and the ones run periodically,
+    // with the earliest time one of the latter is due; the services not
+    // polled at all, not ready or run by the executor are left out
+    std::vector<PolledService> polledServices;
+    std::vector<PolledService> periodicServices;
+    unsigned long periodicDueTime = 0;
+
+    // recreates the lists of the polled services, when a service gets
+    // ready, is registered, or the executor is started or stopped; they are
+    // marked as changed then and recreated by loop(), not while walked
+    void updatePolledServices();
+    bool isPolledServicesChanged = false;
+
+    // runs loop() of the service, measuring it from the given time, returns
+    // the time it ended
+    unsigned long runService(const PolledService &polled, unsigned long time);
+
+    // the services registered by registerStaticService()
+    std::vector<MokoshService *> staticServices;
+
+    // the built-in services, kept out of the registry lookups
+    std::shared_ptr<MokoshNetworkService> networkService;
+    std::shared_ptr<MokoshMqttService> mqttService;
 
     static std::vector<std::shared_ptr<MokoshLogger>> loggers;
+
+    // loggers which are getting messages without formatting
+    static std::vector<std::shared_ptr<MokoshLogger>> rawLoggers;
+
+    // the lowest level accepted by any of the loggers
+    static LogLevel minLogLevel;
+
+    // the lowest level accepted by any of the formatting loggers
+    static LogLevel minFormattedLogLevel;
+
+    // levels set for the tags, overriding levels of the loggers
+    struct TagLogLevel
+    {
+        uint32_t tag;
+        LogLevel level;
+    };
+
+    static TagLogLevel tagLogLevels[MOKOSH_LOG_TAGS];
+    static int tagLogLevelsCount;
+
+    // suppressing windows for every level
+    static unsigned long logRateLimits[LogLevel::ANY + 1];
+
+    // passes formatted message to the loggers accepting it
+    static void passToLoggers(LogLevel level, bool isTagged, MokoshLogger *writer, const char *func, const char *file, int line, long time, const char *msg);
+
+    // queue for asynchronous logging, null if logging is synchronous
+    static std::unique_ptr<MokoshLogQueue> logQueue;
+    static int logDrainPerLoop;
+    static bool isLogTaskRunning;
 };
 
 #include "MokoshResilience.hpp"
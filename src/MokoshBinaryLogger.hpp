@@ -0,0 +1,219 @@
+#ifndef MOKOSHBINARYLOGGER_H
+#define MOKOSHBINARYLOGGER_H
+
+#include <Arduino.h>
+#include "MokoshLogger.hpp"
+#include "MokoshHash.hpp"
+
+// a logger which does not format the messages, but sends compact binary
+// records with the ID of a format string and raw argument values, to be
+// decoded on the host using tools/mokosh_logdecode.py
+//
+// every record is: 0xA5, payload length (1 byte), and the payload:
+// level (1 byte), time (4 bytes), format string ID (4 bytes), line (2 bytes)
+// and the arguments - integers and pointers as 4 bytes (8 bytes for "ll"),
+// floating point as 8 bytes double, strings as length (1 byte) and chars;
+// all numbers are little endian
+class BinaryLogger : public MokoshLogger
+{
+public:
+    static const uint8_t SYNC = 0xA5;
+
+    BinaryLogger(Print &output = Serial) : output(output)
+    {
+    }
+
+    virtual bool setup() override
+    {
+        this->setupFinished = true;
+        return true;
+    }
+
+    virtual void loop() override {}
+
+    virtual unsigned long getPollInterval() override
+    {
+        return MokoshService::POLL_NEVER;
+    }
+
+    virtual bool isFormatting() override
+    {
+        return false;
+    }
+
+    virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) override
+    {
+    }
+
+    virtual void logRaw(LogLevel level, const char *func, const char *file, int line, long time, const char *fmt, va_list args) override
+    {
+        uint8_t record[257];
+        size_t pos = 2;
+
+        record[pos++] = (uint8_t)level;
+        pos = this->putInt(record, pos, (uint32_t)time, 4);
+        pos = this->putInt(record, pos, this->getFormatId(fmt), 4);
+        pos = this->putInt(record, pos, (uint32_t)line, 2);
+
+        const char *p = fmt;
+        while (*p != 0 && pos < sizeof(record) - 1)
+        {
+            if (*p++ != '%')
+                continue;
+
+            // flags, width and precision, '*' takes an int argument; the
+            // precision is also kept, as it limits the length of a string
+            int precision = -1;
+            while (*p != 0 && strchr("-+ #0123456789.*", *p) != nullptr)
+            {
+                if (*p == '*')
+                {
+                    int value = va_arg(args, int);
+                    pos = this->putInt(record, pos, (uint32_t)value, 4);
+                    if (precision >= 0)
+                        precision = value;
+                }
+                else if (*p == '.')
+                    precision = 0;
+                else if (precision >= 0 && *p >= '0' && *p <= '9')
+                    precision = precision * 10 + (*p - '0');
+                p++;
+            }
+
+            int longs = 0;
+            while (*p == 'l' || *p == 'h' || *p == 'z')
+            {
+                if (*p == 'l')
+                    longs++;
+                p++;
+            }
+
+            switch (*p)
+            {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                if (longs >= 2)
+                    pos = this->putInt(record, pos, (uint64_t)va_arg(args, long long), 8);
+                else if (longs == 1)
+                    pos = this->putInt(record, pos, (uint32_t)va_arg(args, long), 4);
+                else
+                    pos = this->putInt(record, pos, (uint32_t)va_arg(args, int), 4);
+                break;
+
+            case 'p':
+                pos = this->putInt(record, pos, (uint32_t)(uintptr_t)va_arg(args, void *), 4);
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            {
+                double value = va_arg(args, double);
+                uint64_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                pos = this->putInt(record, pos, bits, 8);
+                break;
+            }
+
+            case 's':
+            {
+                const char *str = va_arg(args, const char *);
+                if (str == nullptr)
+                    str = "(null)";
+
+                // the '*' arguments may have filled the record, there must
+                // be a place for the length
+                if (pos >= sizeof(record) - 1)
+                    break;
+
+                // the string does not need to be terminated if precision is
+                // given, so it is not read further
+                size_t limit = precision >= 0 && precision < 255 ? precision : 255;
+                size_t length = 0;
+                while (length < limit && str[length] != 0)
+                    length++;
+                if (length > sizeof(record) - pos - 1)
+                    length = sizeof(record) - pos - 1;
+
+                record[pos++] = (uint8_t)length;
+                memcpy(record + pos, str, length);
+                pos += length;
+                break;
+            }
+
+            default:
+                break;
+            }
+
+            if (*p != 0)
+                p++;
+        }
+
+        if (pos > sizeof(record))
+            pos = sizeof(record);
+
+        record[0] = SYNC;
+        record[1] = (uint8_t)(pos - 2);
+        this->output.write(record, pos);
+    }
+
+    virtual void ticker_step() override
+    {
+    }
+
+    virtual void ticker_finish(bool success) override
+    {
+    }
+
+    // returns the ID of a format string, FNV-1a hash of its contents,
+    // the same as calculated by the decoder
+    static uint32_t formatId(const char *fmt)
+    {
+        return MokoshHash::hash(fmt);
+    }
+
+private:
+    Print &output;
+
+    // format strings are literals, so the ID is calculated only once
+    // for every call site and remembered by the pointer
+    struct FormatIdCacheEntry
+    {
+        const char *fmt;
+        uint32_t id;
+    };
+
+    FormatIdCacheEntry formatIdCache[16] = {};
+
+    uint32_t getFormatId(const char *fmt)
+    {
+        FormatIdCacheEntry &entry = this->formatIdCache[((uintptr_t)fmt >> 2) & 15];
+        if (entry.fmt != fmt)
+        {
+            entry.fmt = fmt;
+            entry.id = BinaryLogger::formatId(fmt);
+        }
+
+        return entry.id;
+    }
+
+    size_t putInt(uint8_t *record, size_t pos, uint64_t value, int size)
+    {
+        for (int i = 0; i < size && pos < 257; i++)
+        {
+            record[pos++] = (uint8_t)(value >> (8 * i));
+        }
+
+        return pos;
+    }
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "MokoshCommandRegistry.hpp"
+#include "MokoshHash.hpp"
+
+void MokoshCommandRegistry::add(const char *name, MokoshCommandViewHandler handler, const char *help, const void *owner)
+{
+    size_t length = strlen(name);
+    uint32_t hash = MokoshHash::hash(name, length);
+
+    int i = this->indexOf(name, length, hash);
+    if (i != -1)
+    {
+        this->entries[i].handler = handler;
+        this->entries[i].help = help;
+        this->entries[i].owner = owner;
+        return;
+    }
+
+    char *interned = new char[length + 1];
+    memcpy(interned, name, length + 1);
+
+    MokoshCommand command;
+    command.name.reset(interned);
+    command.hash = hash;
+    command.handler = handler;
+    command.help = help;
+    command.owner = owner;
+    this->entries.push_back(std::move(command));
+
+    this->rebuildIndex();
+}
+
+void MokoshCommandRegistry::removeOwnedBy(const void *owner)
+{
+    if (owner == nullptr)
+        return;
+
+    size_t count = this->entries.size();
+    for (size_t i = 0; i < this->entries.size();)
+    {
+        if (this->entries[i].owner == owner)
+            this->entries.erase(this->entries.begin() + i);
+        else
+            i++;
+    }
+
+    if (this->entries.size() != count)
+        this->rebuildIndex();
+}
+
+const MokoshCommand *MokoshCommandRegistry::find(const char *name, size_t length) const
+{
+    int i = this->indexOf(name, length, MokoshHash::hash(name, length));
+    return i != -1 ? &this->entries[i] : nullptr;
+}
+
+int MokoshCommandRegistry::indexOf(const char *name, size_t length, uint32_t hash) const
+{
+    if (this->index.empty())
+        return -1;
+
+    size_t mask = this->index.size() - 1;
+
+    // the table is never full, so there is always an empty place ending
+    // the search
+    for (size_t place = hash & mask; this->index[place] != 0; place = (place + 1) & mask)
+    {
+        const MokoshCommand &command = this->entries[this->index[place] - 1];
+        if (command.hash == hash && MokoshStringView(name, length).equals(command.getName()))
+            return this->index[place] - 1;
+    }
+
+    return -1;
+}
+
+void MokoshCommandRegistry::rebuildIndex()
+{
+    size_t capacity = 16;
+    while (capacity < this->entries.size() * 2)
+        capacity *= 2;
+
+    this->index.assign(capacity, 0);
+
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < this->entries.size(); i++)
+    {
+        size_t place = this->entries[i].hash & mask;
+        while (this->index[place] != 0)
+            place = (place + 1) & mask;
+
+        this->index[place] = i + 1;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef MOKOSHCOMMANDREGISTRY_H
+#define MOKOSHCOMMANDREGISTRY_H
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "MokoshStringView.hpp"
+
+// handles a command, gets the part after '=' (or an empty string)
+typedef std::function<void(const String &param)> MokoshCommandHandler;
+
+// handles a command, gets a view of the part after '=' in the received
+// message, so nothing is allocated on the way
+typedef std::function<void(MokoshStringView param)> MokoshCommandViewHandler;
+
+// a command registered by a name
+struct MokoshCommand
+{
+    // the interned name
+    std::unique_ptr<char[]> name;
+    uint32_t hash;
+
+    MokoshCommandViewHandler handler;
+
+    // description shown by the help command, may be null
+    const char *help;
+
+    // the object which registered the command, so its commands can be
+    // removed together, may be null
+    const void *owner;
+
+    const char *getName() const
+    {
+        return this->name.get();
+    }
+};
+
+// the commands registered by names, iterated in the order of registration
+//
+// the names are copied on registration and found by hash in O(1), the help
+// texts are not copied, so they should be literals
+class MokoshCommandRegistry
+{
+public:
+    typedef std::vector<MokoshCommand>::const_iterator const_iterator;
+
+    // registers a command, replacing the one already registered under the
+    // same name
+    void add(const char *name, MokoshCommandViewHandler handler, const char *help = nullptr, const void *owner = nullptr);
+
+    // registers a command getting the parameter as String, which is copied
+    // for every call
+    void add(const char *name, MokoshCommandHandler handler, const char *help = nullptr, const void *owner = nullptr)
+    {
+        this->add(
+            name, [handler](MokoshStringView param)
+            { handler(param.toString()); },
+            help, owner);
+    }
+
+    // removes all the commands registered by a given owner
+    void removeOwnedBy(const void *owner);
+
+    // returns the command registered under a name of a given length, or null
+    const MokoshCommand *find(const char *name, size_t length) const;
+
+    // returns the command registered under a name, or null
+    const MokoshCommand *find(const char *name) const
+    {
+        return this->find(name, strlen(name));
+    }
+
+    size_t size() const
+    {
+        return this->entries.size();
+    }
+
+    const_iterator begin() const
+    {
+        return this->entries.begin();
+    }
+
+    const_iterator end() const
+    {
+        return this->entries.end();
+    }
+
+private:
+    std::vector<MokoshCommand> entries;
+
+    // open addressing table with positions of the entries plus one, 0 for
+    // empty places, at least twice as large as the number of entries
+    std::vector<uint16_t> index;
+
+    // returns position of the command registered under a name, or -1
+    int indexOf(const char *name, size_t length, uint32_t hash) const;
+
+    // recreates the table for the current number of entries
+    void rebuildIndex();
+};
+
+#endif
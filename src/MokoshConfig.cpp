@@ -46,22 +46,29 @@ bool MokoshConfig::configFileExists()
 
 void MokoshConfig::set(const char *field, String value)
 {
-    this->config[field] = value;
+    MokoshLock lock(this->mutex);
+    this->config[(char *)field] = value;
 }
 
 void MokoshConfig::set(const char *field, const char *value)
 {
-    this->config[field] = value;
+    MokoshLock lock(this->mutex);
+
+    // ArduinoJson keeps const char * by pointer, but the field and the
+    // value may be on the stack of a command handler, so they are copied
+    this->config[(char *)field] = (char *)value;
 }
 
 void MokoshConfig::set(const char *field, int value)
 {
-    this->config[field] = value;
+    MokoshLock lock(this->mutex);
+    this->config[(char *)field] = value;
 }
 
 void MokoshConfig::set(const char *field, float value)
 {
-    this->config[field] = value;
+    MokoshLock lock(this->mutex);
+    this->config[(char *)field] = value;
 }
 
 void MokoshConfig::saveConfig()
@@ -78,6 +85,7 @@ void MokoshConfig::saveConfig()
     File configFile = LittleFS.open("/config.json", "w");
 #endif
 
+    MokoshLock lock(this->mutex);
     serializeJson(this->config, configFile);
 }
 
@@ -108,6 +116,7 @@ bool MokoshConfig::reloadFromFile()
         return false;
     }
 
+    MokoshLock lock(this->mutex);
     deserializeJson(this->config, configFile);
 
     return true;
@@ -115,6 +124,7 @@ bool MokoshConfig::reloadFromFile()
 
 bool MokoshConfig::hasKey(const char *field)
 {
+    MokoshLock lock(this->mutex);
     return this->config.containsKey(field);
 }
 
@@ -151,79 +161,103 @@ void MokoshConfig::loop()
 {
 }
 
-bool MokoshConfig::command(String command, String param)
+void MokoshConfig::registerCommands(MokoshCommandRegistry &commands)
 {
-    if (command == "saveconfig")
-    {
-        mlogD("Config saved");
-        this->saveConfig();
-        return true;
-    }
-
-    if (command == "showconfigs")
-    {
-        String value = this->get<String>(param.c_str());
-        mlogD("config %s = %s", param.c_str(), value.c_str());
-        return true;
-    }
-
-    if (command == "showconfigi")
-    {
-        int value = this->get<int>(param.c_str());
-        mlogD("config %s = %i", param.c_str(), value);
-        return true;
-    }
-
-    if (command == "showconfigf")
-    {
-        float value = this->get<float>(param.c_str());
-        mlogD("config %s = %f", param.c_str(), value);
-        return true;
-    }
-
-    if (command == "setconfigs")
-    {
-        String field = param.substring(0, param.indexOf('|'));
-        String value = param.substring(param.indexOf('|') + 1);
-
-        mlogD("Setting configuration: field: %s, new value: %s", field.c_str(), value.c_str());
-
-        this->set(field.c_str(), value);
-
-        return true;
-    }
-
-    if (command == "setconfigi")
-    {
-        String field = param.substring(0, param.indexOf('|'));
-        String value = param.substring(param.indexOf('|') + 1);
-
-        mlogD("Setting configuration: field: %s, new value: %d", field.c_str(), value.toInt());
-
-        this->set(field.c_str(), (int)(value.toInt()));
-
-        return true;
-    }
-
-    if (command == "setconfigf")
-    {
-        String field = param.substring(0, param.indexOf('|'));
-        String value = param.substring(param.indexOf('|') + 1);
-
-        mlogD("Setting configuration: field: %s, new value: %f", field.c_str(), value.toFloat());
-
-        this->set(field.c_str(), value.toFloat());
-
-        return true;
-    }
-
-    if (command == "reloadconfig")
-    {
-        mlogI("Config reload initiated");
-        this->reloadFromFile();
+    commands.add(
+        "saveconfig", [this](MokoshStringView param)
+        {
+            mlogD("Config saved");
+            this->saveConfig();
+        },
+        "saves the configuration to the file", this);
+
+    commands.add(
+        "showconfigs", [this](MokoshStringView param)
+        {
+            char field[MOKOSH_CONFIG_FIELD_SIZE];
+            param.copyTo(field, sizeof(field));
+
+            // points into the document, which is not changed before it is logged
+            const char *value = this->get<const char *>(field, "");
+            mlogD("config %s = %s", field, value);
+        },
+        "logs a string field: showconfigs=field", this);
+
+    commands.add(
+        "showconfigi", [this](MokoshStringView param)
+        {
+            char field[MOKOSH_CONFIG_FIELD_SIZE];
+            param.copyTo(field, sizeof(field));
+
+            int value = this->get<int>(field);
+            mlogD("config %s = %i", field, value);
+        },
+        "logs an integer field: showconfigi=field", this);
+
+    commands.add(
+        "showconfigf", [this](MokoshStringView param)
+        {
+            char field[MOKOSH_CONFIG_FIELD_SIZE];
+            param.copyTo(field, sizeof(field));
+
+            float value = this->get<float>(field);
+            mlogD("config %s = %f", field, value);
+        },
+        "logs a float field: showconfigf=field", this);
+
+    commands.add(
+        "setconfigs", [this](MokoshStringView param)
+        {
+            char field[MOKOSH_CONFIG_FIELD_SIZE];
+            MokoshStringView value = this->splitFieldValue(param, field, sizeof(field));
+
+            char text[MOKOSH_COMMAND_SIZE];
+            value.copyTo(text, sizeof(text));
+
+            mlogD("Setting configuration: field: %s, new value: %s", field, text);
+
+            this->set(field, text);
+        },
+        "sets a string field: setconfigs=field|value", this);
+
+    commands.add(
+        "setconfigi", [this](MokoshStringView param)
+        {
+            char field[MOKOSH_CONFIG_FIELD_SIZE];
+            MokoshStringView value = this->splitFieldValue(param, field, sizeof(field));
+
+            mlogD("Setting configuration: field: %s, new value: %ld", field, value.toInt());
+
+            this->set(field, (int)(value.toInt()));
+        },
+        "sets an integer field: setconfigi=field|value", this);
+
+    commands.add(
+        "setconfigf", [this](MokoshStringView param)
+        {
+            char field[MOKOSH_CONFIG_FIELD_SIZE];
+            MokoshStringView value = this->splitFieldValue(param, field, sizeof(field));
+
+            mlogD("Setting configuration: field: %s, new value: %f", field, value.toFloat());
+
+            this->set(field, value.toFloat());
+        },
+        "sets a float field: setconfigf=field|value", this);
+
+    commands.add(
+        "reloadconfig", [this](MokoshStringView param)
+        {
+            mlogI("Config reload initiated");
+            this->reloadFromFile();
+        },
+        "reloads the configuration from the file", this);
+}
 
-        return true;
-    }
+MokoshStringView MokoshConfig::splitFieldValue(MokoshStringView param, char *field, size_t size)
+{
+    // without the separator, the whole parameter is both
+    int sep = param.indexOf('|');
+    param.substring(0, sep > -1 ? sep : param.length).copyTo(field, size);
 
-    return false;
-}
\ No newline at end of file
+    return param.substring(sep + 1);
+}
@@ -4,8 +4,18 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include "MokoshMutex.hpp"
 #include "MokoshService.hpp"
+#include "MokoshStringView.hpp"
 
+// the longest name of a field (with the null terminator) given in the
+// configuration commands, they are copied on the stack
+#if !defined(MOKOSH_CONFIG_FIELD_SIZE)
+#define MOKOSH_CONFIG_FIELD_SIZE 32
+#endif
+
+// configuration of the device, it may be read and changed from the services
+// run by the executor, so the access to the fields is guarded by a mutex
 class MokoshConfig : public MokoshService
 {
 public:
@@ -24,6 +34,8 @@ public:
     // reads a given field from config.json
     T get(const char *field, T def = T())
     {
+        MokoshLock lock(this->mutex);
+
         if (!this->config.containsKey(field))
         {
             // mlogW("config.json field %s does not exist!", field);
@@ -70,18 +82,30 @@ public:
     // unused, but required by services
     virtual void loop() override;
 
+    // loop() is empty, so it is not run
+    virtual unsigned long getPollInterval() override
+    {
+        return MokoshService::POLL_NEVER;
+    }
+
     virtual std::vector<const char *> getDependencies() override
     {
         return {};
     }
 
-    virtual bool command(String command, String param) override;
+    virtual void registerCommands(MokoshCommandRegistry &commands) override;
 
     static const char *KEY;
 
 private:
     StaticJsonDocument<1024> config;
     bool useFileSystem;
+
+    MokoshMutex mutex;
+
+    // copies the field name of a "field|value" parameter of the set
+    // commands to a buffer, returns a view of the value
+    MokoshStringView splitFieldValue(MokoshStringView param, char *field, size_t size);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef MOKOSHEXECUTIONSTATS_H
+#define MOKOSHEXECUTIONSTATS_H
+
+#include <Arduino.h>
+
+// how many overruns in a row make a demotable timer demoted
+#if !defined(MOKOSH_OVERRUN_DEMOTE_LIMIT)
+#define MOKOSH_OVERRUN_DEMOTE_LIMIT 3
+#endif
+
+// execution time statistics of a callback (a timer function or a service
+// loop) with an optional time budget, all times in microseconds
+struct MokoshExecutionStats
+{
+    // the longest expected execution time, 0 if there is no budget
+    unsigned long budget = 0;
+
+    unsigned long lastDuration = 0;
+    unsigned long maxDuration = 0;
+    uint64_t totalDuration = 0;
+    uint32_t count = 0;
+
+    // number of executions longer than the budget, in total and in a row
+    uint32_t overrunCount = 0;
+    uint16_t consecutiveOverruns = 0;
+
+    // records a single execution, returns true if it has exceeded the budget
+    bool record(unsigned long duration)
+    {
+        this->lastDuration = duration;
+        this->totalDuration += duration;
+        this->count++;
+        if (duration > this->maxDuration)
+            this->maxDuration = duration;
+
+        if (this->budget == 0 || duration <= this->budget)
+        {
+            this->consecutiveOverruns = 0;
+            return false;
+        }
+
+        this->overrunCount++;
+        if (this->consecutiveOverruns < UINT16_MAX)
+            this->consecutiveOverruns++;
+
+        return true;
+    }
+
+    // clears the statistics, the budget is kept
+    void reset()
+    {
+        unsigned long budget = this->budget;
+        *this = MokoshExecutionStats();
+        this->budget = budget;
+    }
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "MokoshExecutor.hpp"
+
+#if MOKOSH_EXECUTOR
+bool MokoshExecutor::start(int core, uint32_t stackSize, size_t capacity)
+{
+    if (this->isStarted)
+        return true;
+
+    this->toWorker.reset(new MokoshJobQueue(capacity));
+    this->toLoop.reset(new MokoshJobQueue(capacity));
+    this->isStopping = false;
+    this->isStopped = false;
+
+#if defined(ESP32)
+#if CONFIG_FREERTOS_UNICORE
+    core = 0;
+#endif
+    if (xTaskCreatePinnedToCore(MokoshExecutor::taskFunction, "mokosh_exec", stackSize, this, 1, &this->task, core) != pdPASS)
+        return false;
+#else
+    this->thread = std::thread([this]()
+                               {
+                                   // the thread handle is used by isWorker(),
+                                   // so it must be stored first
+                                   while (!this->isStarted)
+                                       std::this_thread::yield();
+
+                                   while (!this->isStopping)
+                                   {
+                                       this->work();
+                                       this->wait();
+                                   }
+                                   this->isStopped = true; });
+#endif
+
+    this->isStarted = true;
+    return true;
+}
+
+#if defined(ESP32)
+void MokoshExecutor::taskFunction(void *parameters)
+{
+    MokoshExecutor *executor = (MokoshExecutor *)parameters;
+
+    // the task may run before xTaskCreatePinnedToCore returns, and the task
+    // handle is used by isWorker() and wake(), so it must be stored first
+    while (!executor->isStarted)
+        vTaskDelay(1);
+
+    while (!executor->isStopping)
+    {
+        executor->work();
+        executor->wait();
+    }
+
+    executor->isStopped = true;
+    vTaskDelete(nullptr);
+}
+#endif
+
+void MokoshExecutor::stop()
+{
+    if (!this->isStarted)
+        return;
+
+    this->isStopping = true;
+    this->wake();
+
+#if defined(ESP32)
+    while (!this->isStopped)
+        delay(1);
+#else
+    this->thread.join();
+#endif
+
+    this->isStarted = false;
+    this->services.clear();
+
+    {
+        MokoshLock lock(this->servicesMutex);
+        this->newServices.clear();
+    }
+
+    // the jobs which were not run yet are run here, so none is lost
+    MokoshJob job;
+    while (this->toWorker->pop(job))
+        job();
+}
+
+bool MokoshExecutor::isWorker()
+{
+    if (!this->isStarted)
+        return false;
+
+#if defined(ESP32)
+    return xTaskGetCurrentTaskHandle() == this->task;
+#else
+    return std::this_thread::get_id() == this->thread.get_id();
+#endif
+}
+
+bool MokoshExecutor::execute(MokoshJob job)
+{
+    if (!this->isStarted)
+    {
+        job();
+        return true;
+    }
+
+    if (!this->toWorker->push(job))
+        return false;
+
+    this->wake();
+    return true;
+}
+
+void MokoshExecutor::wake()
+{
+#if defined(ESP32)
+    xTaskNotifyGive(this->task);
+#else
+    this->isWakeRequested = true;
+    this->wakeCondition.notify_one();
+#endif
+}
+
+void MokoshExecutor::wait()
+{
+#if defined(ESP32)
+    // blocks for a tick if nothing is waiting, so the lower priority tasks
+    // (and the idle task feeding the watchdog) can run
+    ulTaskNotifyTake(pdTRUE, 1);
+#else
+    // if the wake up happens right before waiting, it is only a millisecond
+    // late
+    std::unique_lock<std::mutex> lock(this->wakeMutex);
+    this->wakeCondition.wait_for(lock, std::chrono::milliseconds(1), [this]()
+                                 { return this->isWakeRequested.exchange(false); });
+#endif
+}
+
+bool MokoshExecutor::post(MokoshJob job)
+{
+    if (!this->isStarted)
+    {
+        job();
+        return true;
+    }
+
+    return this->toLoop->push(job);
+}
+
+int MokoshExecutor::runPosted(int max)
+{
+    if (this->toLoop == nullptr)
+        return 0;
+
+    int count = 0;
+    MokoshJob job;
+    while (count < max && this->toLoop->pop(job))
+    {
+        job();
+        count++;
+    }
+
+    return count;
+}
+
+void MokoshExecutor::addService(std::shared_ptr<MokoshService> service)
+{
+    MokoshLock lock(this->servicesMutex);
+    this->newServices.push_back(service);
+}
+
+int MokoshExecutor::work()
+{
+    {
+        MokoshLock lock(this->servicesMutex);
+        for (auto &service : this->newServices)
+            this->services.push_back(service);
+
+        this->newServices.clear();
+    }
+
+    int count = 0;
+    MokoshJob job;
+    while (this->toWorker->pop(job))
+    {
+        job();
+        count++;
+    }
+
+    for (auto &service : this->services)
+        service->loop();
+
+    return count;
+}
+#endif
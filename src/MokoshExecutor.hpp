@@ -0,0 +1,142 @@
+#ifndef MOKOSHEXECUTOR_H
+#define MOKOSHEXECUTOR_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "MokoshMutex.hpp"
+#include "MokoshService.hpp"
+
+// the executor is available where there are threads: on ESP32 it is a task
+// pinned to a core, elsewhere a std::thread
+#define MOKOSH_EXECUTOR MOKOSH_THREADS
+
+#if MOKOSH_EXECUTOR && !defined(ESP32)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+typedef std::function<void(void)> MokoshJob;
+
+// a lock-free queue of jobs passed from one thread to another, only one
+// thread may push and only one may pop
+class MokoshJobQueue
+{
+public:
+    MokoshJobQueue(size_t capacity) : jobs(new MokoshJob[capacity]), capacity(capacity)
+    {
+    }
+
+    // adds a job to the queue, returns false if it is full
+    bool push(MokoshJob job)
+    {
+        uint32_t h = this->head.load(std::memory_order_relaxed);
+        if (h - this->tail.load(std::memory_order_acquire) >= this->capacity)
+            return false;
+
+        this->jobs[h % this->capacity] = std::move(job);
+        this->head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // takes the oldest job out of the queue, returns false if it is empty
+    bool pop(MokoshJob &job)
+    {
+        uint32_t t = this->tail.load(std::memory_order_relaxed);
+        if (t == this->head.load(std::memory_order_acquire))
+            return false;
+
+        job = std::move(this->jobs[t % this->capacity]);
+        this->jobs[t % this->capacity] = nullptr;
+        this->tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::unique_ptr<MokoshJob[]> jobs;
+    size_t capacity;
+
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+};
+
+#if MOKOSH_EXECUTOR
+// a worker running loop() of the services which opted in and the jobs passed
+// from the main loop, in a separate thread
+class MokoshExecutor
+{
+public:
+    // starts the worker, on ESP32 pinned to a given core, with queues for
+    // capacity jobs in each direction; returns false if it cannot be started
+    bool start(int core = 0, uint32_t stackSize = 8192, size_t capacity = 16);
+
+    // stops the worker, waiting for the current round of work to finish
+    void stop();
+
+    // returns if the worker is running
+    bool isRunning()
+    {
+        return this->isStarted;
+    }
+
+    // returns if called from the worker
+    bool isWorker();
+
+    // runs the job on the worker, must be called from the main loop,
+    // returns false if the queue is full
+    bool execute(MokoshJob job);
+
+    // runs the job in the main loop, must be called from the worker,
+    // returns false if the queue is full
+    bool post(MokoshJob job);
+
+    // runs at most max jobs posted to the main loop, returns how many were
+    // run; called by Mokosh::loop()
+    int runPosted(int max);
+
+    // makes the worker run loop() of the service
+    void addService(std::shared_ptr<MokoshService> service);
+
+private:
+    std::unique_ptr<MokoshJobQueue> toWorker;
+    std::unique_ptr<MokoshJobQueue> toLoop;
+
+    // services are added by the main loop and taken by the worker
+    MokoshMutex servicesMutex;
+    std::vector<std::shared_ptr<MokoshService>> newServices;
+
+    // used only by the worker
+    std::vector<std::shared_ptr<MokoshService>> services;
+
+    std::atomic<bool> isStarted{false};
+    std::atomic<bool> isStopping{false};
+    std::atomic<bool> isStopped{false};
+
+#if defined(ESP32)
+    TaskHandle_t task = nullptr;
+    static void taskFunction(void *parameters);
+#else
+    std::thread thread;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<bool> isWakeRequested{false};
+#endif
+
+    // wakes the worker up when a job is waiting
+    void wake();
+
+    // waits at most a millisecond, or until the worker is woken up
+    void wait();
+
+    // a single round of the worker: the jobs and loop() of the services,
+    // returns number of jobs run
+    int work();
+};
+#endif
+
+#endif
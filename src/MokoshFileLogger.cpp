@@ -0,0 +1,7 @@
+#include "MokoshFileLogger.hpp"
+
+#if defined(ESP32) || defined(ESP8266)
+
+const char *FileLogger::KEY = "FILE_DEBUG";
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef MOKOSHFILELOGGER_H
+#define MOKOSHFILELOGGER_H
+
+#if defined(ESP32) || defined(ESP8266)
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <memory>
+#include <Mokosh.hpp>
+
+// a logger which stores log lines in the filesystem, so they survive resets
+//
+// lines are collected in a RAM page and appended to the current segment
+// file (/logs/N.log) only when the page is full, on error, or when the flush
+// interval passes; when the segment is full, the next one is overwritten,
+// so the last segmentCount segments are kept
+//
+// the files are plain text, the same lines as printed by SerialLogger
+class FileLogger : public MokoshLogger
+{
+public:
+    FileLogger(size_t segmentSize = 16384, int segmentCount = 4, size_t pageSize = 256, unsigned long flushInterval = 30000, fs::FS &filesystem = LittleFS)
+        : filesystem(filesystem), page(new char[pageSize]), pageSize(pageSize), segmentSize(segmentSize), segmentCount(segmentCount), flushInterval(flushInterval)
+    {
+        // lines logged before setup are kept in the page, after the marker
+        this->appendLine("=== boot ===\n");
+    }
+
+    virtual bool setup() override
+    {
+        if (!this->filesystem.begin())
+        {
+            mlogE("Filesystem is not available, file logger disabled");
+            return false;
+        }
+
+        if (!this->filesystem.exists("/logs"))
+            this->filesystem.mkdir("/logs");
+
+        // continuing the segment used before the reset
+        File index = this->filesystem.open("/logs/index", "r");
+        if (index)
+        {
+            this->segment = index.parseInt() % this->segmentCount;
+            index.close();
+        }
+
+        File current = this->filesystem.open(this->segmentPath(this->segment), "r");
+        if (current)
+        {
+            this->segmentLength = current.size();
+            current.close();
+        }
+
+        this->setupFinished = true;
+        this->lastFlush = millis();
+
+        return true;
+    }
+
+    virtual void loop() override
+    {
+        if (this->pageLength > 0 && millis() - this->lastFlush >= this->flushInterval)
+            this->flush();
+
+        if (this->isDumping)
+            this->dumpChunk();
+    }
+
+    // often enough for a dump to be published quickly
+    virtual unsigned long getPollInterval() override
+    {
+        return 10;
+    }
+
+    virtual const char *key() override
+    {
+        return FileLogger::KEY;
+    }
+
+    virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) override
+    {
+        // dumping is logging by itself, these lines are ignored
+        if (this->isPublishing)
+            return;
+
+        char text[320];
+        snprintf(text, sizeof(text), "(%c t:%ldms) (%s %s:%d) %s\n", this->levelToChar(level), time, func, file, line, msg);
+        this->lineStart = this->pageLength;
+        this->appendLine(text);
+
+        if (level >= LogLevel::ERROR)
+            this->flush();
+    }
+
+    // the message is appended to the page directly, without collecting it first
+    virtual void logBegin(LogLevel level, const char *func, const char *file, int line, long time) override
+    {
+        this->pendingLevel = level;
+        this->lineStart = this->pageLength;
+        this->isLineDropped = false;
+        if (this->isPublishing)
+            return;
+
+        char text[96];
+        snprintf(text, sizeof(text), "(%c t:%ldms) (%s %s:%d) ", this->levelToChar(level), time, func, file, line);
+        this->appendLine(text);
+    }
+
+    virtual void logWrite(const char *chunk, size_t length) override
+    {
+        if (!this->isPublishing && !this->isLineDropped)
+            this->append(chunk, length);
+    }
+
+    virtual void logEnd() override
+    {
+        if (this->isPublishing || this->isLineDropped)
+            return;
+
+        this->appendLine("\n");
+
+        if (this->pendingLevel >= LogLevel::ERROR)
+            this->flush();
+    }
+
+    virtual void ticker_step() override
+    {
+    }
+
+    virtual void ticker_finish(bool success) override
+    {
+    }
+
+    virtual void registerCommands(MokoshCommandRegistry &commands) override
+    {
+        commands.add(
+            "dumplogs", [this](MokoshStringView param)
+            {
+                this->flush();
+
+                // starting from the oldest segment
+                this->dumpSegment = (this->segment + 1) % this->segmentCount;
+                this->dumpRemaining = this->segmentCount;
+                this->dumpOffset = 0;
+                this->isDumping = true;
+            },
+            "publishes the stored logs on debug/logs", this);
+    }
+
+    // writes the lines collected in the page to the current segment
+    void flush()
+    {
+        if (!this->setupFinished || this->pageLength == 0)
+            return;
+
+        this->lastFlush = millis();
+
+        if (this->segmentLength + this->pageLength > this->segmentSize)
+            this->rotate();
+
+        File file = this->filesystem.open(this->segmentPath(this->segment), "a");
+        if (file)
+        {
+            file.write((const uint8_t *)this->page.get(), this->pageLength);
+            file.close();
+            this->segmentLength += this->pageLength;
+        }
+
+        this->pageLength = 0;
+    }
+
+    // returns if the segments are being published at the moment
+    bool isDumpInProgress()
+    {
+        return this->isDumping;
+    }
+
+    static const char *KEY;
+
+    // size of a single message published by dumplogs
+    static const size_t DUMP_CHUNK_SIZE = 128;
+
+    // the subtopic on which the segments are published by dumplogs, an empty
+    // message is published when all were sent
+    const char *dump_topic = "debug/logs";
+
+private:
+    fs::FS &filesystem;
+
+    std::unique_ptr<char[]> page;
+    size_t pageSize;
+    size_t pageLength = 0;
+
+    size_t segmentSize;
+    int segmentCount;
+    int segment = 0;
+    size_t segmentLength = 0;
+
+    unsigned long flushInterval;
+    unsigned long lastFlush = 0;
+
+    bool isPublishing = false;
+    bool isDumping = false;
+    int dumpSegment = 0;
+    int dumpRemaining = 0;
+    size_t dumpOffset = 0;
+
+    String segmentPath(int number)
+    {
+        return String("/logs/") + String(number) + ".log";
+    }
+
+    LogLevel pendingLevel = LogLevel::ANY;
+    size_t lineStart = 0;
+    bool isLineDropped = false;
+
+    void appendLine(const char *text)
+    {
+        this->append(text, strlen(text));
+    }
+
+    void append(const char *text, size_t length)
+    {
+        // texts longer than a page are truncated
+        if (length > this->pageSize)
+            length = this->pageSize;
+
+        if (this->pageLength + length > this->pageSize)
+            this->flush();
+
+        // before setup the page cannot be written, so the whole line is lost
+        if (this->pageLength + length > this->pageSize)
+        {
+            this->pageLength = this->lineStart;
+            this->isLineDropped = true;
+            return;
+        }
+
+        memcpy(this->page.get() + this->pageLength, text, length);
+        this->pageLength += length;
+    }
+
+    // moves to the next segment, overwriting the oldest one
+    void rotate()
+    {
+        this->segment = (this->segment + 1) % this->segmentCount;
+        this->segmentLength = 0;
+
+        File file = this->filesystem.open(this->segmentPath(this->segment), "w");
+        file.close();
+
+        File index = this->filesystem.open("/logs/index", "w");
+        if (index)
+        {
+            index.print(this->segment);
+            index.close();
+        }
+    }
+
+    // publishes one chunk of the segments, run from loop()
+    void dumpChunk()
+    {
+        auto mqtt = Mokosh::getInstance()->getMqttService();
+        if (mqtt == nullptr || !mqtt->isConnected())
+            return;
+
+        char chunk[DUMP_CHUNK_SIZE + 1];
+        size_t length = 0;
+
+        File file = this->filesystem.open(this->segmentPath(this->dumpSegment), "r");
+        if (file)
+        {
+            file.seek(this->dumpOffset);
+            length = file.read((uint8_t *)chunk, DUMP_CHUNK_SIZE);
+            file.close();
+        }
+
+        this->isPublishing = true;
+        if (length > 0)
+        {
+            chunk[length] = 0;
+            mqtt->publish(this->dump_topic, chunk);
+            this->dumpOffset += length;
+        }
+        else
+        {
+            // the segment has ended, moving to the next one
+            this->dumpOffset = 0;
+            this->dumpSegment = (this->dumpSegment + 1) % this->segmentCount;
+            this->dumpRemaining--;
+
+            if (this->dumpRemaining == 0)
+            {
+                mqtt->publish(this->dump_topic, "");
+                this->isDumping = false;
+            }
+        }
+        this->isPublishing = false;
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,549 @@
+#include "MokoshFormat.hpp"
+#include "MokoshHash.hpp"
+#include <math.h>
+
+namespace
+{
+// a single conversion specification, like %-08.3ld
+struct FormatSpec
+{
+    bool isLeft = false;
+    bool isZero = false;
+    bool isPlus = false;
+    bool isSpace = false;
+    bool isAlternate = false;
+    int width = 0;
+    int precision = -1;
+    int longs = 0;
+    bool isSize = false;
+    char conversion = 0;
+};
+
+// value of an argument, as read from va_list
+union FormatValue
+{
+    int64_t i;
+    uint64_t u;
+    double d;
+    const char *s;
+};
+
+// collects the text in a small chunk and passes it to the sink when full,
+// long pieces of text are passed without copying
+class ChunkWriter
+{
+public:
+    ChunkWriter(MokoshFormatSink &sink) : sink(sink)
+    {
+    }
+
+    void put(char c)
+    {
+        if (this->length == sizeof(this->chunk))
+            this->flush();
+
+        this->chunk[this->length++] = c;
+        this->total++;
+    }
+
+    void put(const char *text, size_t length)
+    {
+        if (this->length + length > sizeof(this->chunk))
+            this->flush();
+
+        if (length >= sizeof(this->chunk))
+        {
+            this->sink.write(text, length);
+        }
+        else
+        {
+            memcpy(this->chunk + this->length, text, length);
+            this->length += length;
+        }
+
+        this->total += length;
+    }
+
+    void pad(char c, int count)
+    {
+        for (int i = 0; i < count; i++)
+            this->put(c);
+    }
+
+    void flush()
+    {
+        if (this->length > 0)
+            this->sink.write(this->chunk, this->length);
+
+        this->length = 0;
+    }
+
+    size_t getTotal()
+    {
+        return this->total;
+    }
+
+private:
+    MokoshFormatSink &sink;
+    char chunk[32];
+    size_t length = 0;
+    size_t total = 0;
+};
+}
+
+// reads the specification after '%', p points after the conversion
+// character afterwards; '*' width and precision are read from args
+static void parseSpec(const char *&p, FormatSpec &spec, va_list &args)
+{
+    for (;; p++)
+    {
+        if (*p == '-')
+            spec.isLeft = true;
+        else if (*p == '0')
+            spec.isZero = true;
+        else if (*p == '+')
+            spec.isPlus = true;
+        else if (*p == ' ')
+            spec.isSpace = true;
+        else if (*p == '#')
+            spec.isAlternate = true;
+        else
+            break;
+    }
+
+    if (*p == '*')
+    {
+        spec.width = va_arg(args, int);
+        if (spec.width < 0)
+        {
+            spec.isLeft = true;
+            spec.width = -spec.width;
+        }
+        p++;
+    }
+    else
+    {
+        while (*p >= '0' && *p <= '9')
+            spec.width = spec.width * 10 + (*p++ - '0');
+    }
+
+    if (*p == '.')
+    {
+        p++;
+        spec.precision = 0;
+        if (*p == '*')
+        {
+            spec.precision = va_arg(args, int);
+            p++;
+        }
+        else
+        {
+            while (*p >= '0' && *p <= '9')
+                spec.precision = spec.precision * 10 + (*p++ - '0');
+        }
+    }
+
+    for (;; p++)
+    {
+        if (*p == 'l')
+            spec.longs++;
+        else if (*p == 'z')
+            spec.isSize = true;
+        else if (*p != 'h')
+            break;
+    }
+
+    spec.conversion = *p;
+    if (*p != 0)
+        p++;
+}
+
+// reads the argument for the specification, returns false if the
+// conversion is unknown and no argument was read
+static bool readValue(const FormatSpec &spec, FormatValue &value, va_list &args)
+{
+    switch (spec.conversion)
+    {
+    case 'd':
+    case 'i':
+        if (spec.longs >= 2)
+            value.i = va_arg(args, long long);
+        else if (spec.longs == 1)
+            value.i = va_arg(args, long);
+        else if (spec.isSize)
+            value.i = (int64_t)va_arg(args, size_t);
+        else
+            value.i = va_arg(args, int);
+        return true;
+
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'c':
+        if (spec.longs >= 2)
+            value.u = va_arg(args, unsigned long long);
+        else if (spec.longs == 1)
+            value.u = va_arg(args, unsigned long);
+        else if (spec.isSize)
+            value.u = va_arg(args, size_t);
+        else
+            value.u = va_arg(args, unsigned int);
+        return true;
+
+    case 'p':
+        value.u = (uintptr_t)va_arg(args, void *);
+        return true;
+
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        value.d = va_arg(args, double);
+        return true;
+
+    case 's':
+        value.s = va_arg(args, const char *);
+        if (value.s == nullptr)
+            value.s = "(null)";
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// writes the number with sign, prefix and padding
+static void putNumber(ChunkWriter &out, const FormatSpec &spec, const char *sign, const char *digits, size_t length)
+{
+    size_t signLength = strlen(sign);
+    int zeros = spec.precision > (int)length ? spec.precision - length : 0;
+    int padding = spec.width - (int)(signLength + zeros + length);
+
+    // zero flag is ignored for integers with precision
+    bool isZeroPadded = spec.isZero && !spec.isLeft && (spec.precision < 0 || spec.conversion == 'f' || spec.conversion == 'F');
+
+    if (!spec.isLeft && !isZeroPadded)
+        out.pad(' ', padding);
+
+    out.put(sign, signLength);
+
+    if (isZeroPadded)
+        out.pad('0', padding);
+
+    out.pad('0', zeros);
+    out.put(digits, length);
+
+    if (spec.isLeft)
+        out.pad(' ', padding);
+}
+
+// converts the number to digits at the end of the buffer, returns the
+// position of the first digit
+static char *toDigits(char *end, uint64_t value, int base, bool isUpper)
+{
+    const char *symbols = isUpper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *p = end;
+
+    do
+    {
+        *--p = symbols[value % base];
+        value /= base;
+    } while (value > 0);
+
+    return p;
+}
+
+static void putInteger(ChunkWriter &out, FormatSpec spec, const FormatValue &value)
+{
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    const char *sign = "";
+    uint64_t magnitude = value.u;
+
+    if (spec.conversion == 'd' || spec.conversion == 'i')
+    {
+        if (value.i < 0)
+        {
+            sign = "-";
+            magnitude = -(uint64_t)value.i;
+        }
+        else if (spec.isPlus)
+            sign = "+";
+        else if (spec.isSpace)
+            sign = " ";
+    }
+
+    int base = 10;
+    if (spec.conversion == 'x' || spec.conversion == 'X' || spec.conversion == 'p')
+        base = 16;
+    else if (spec.conversion == 'o')
+        base = 8;
+
+    if (spec.conversion == 'p' || (spec.isAlternate && magnitude != 0 && base == 16))
+        sign = spec.conversion == 'X' ? "0X" : "0x";
+
+    // zero with zero precision is printed as nothing
+    if (spec.precision == 0 && magnitude == 0)
+    {
+        putNumber(out, spec, sign, end, 0);
+        return;
+    }
+
+    char *start = toDigits(end, magnitude, base, spec.conversion == 'X');
+    if (spec.isAlternate && base == 8 && *start != '0')
+        *--start = '0';
+
+    putNumber(out, spec, sign, start, end - start);
+}
+
+// formats the conversion with snprintf, for the rarely used ones
+static void putFallback(ChunkWriter &out, const FormatSpec &spec, const FormatValue &value)
+{
+    char fmt[24];
+    char *p = fmt;
+    *p++ = '%';
+    if (spec.isLeft)
+        *p++ = '-';
+    if (spec.isZero)
+        *p++ = '0';
+    if (spec.isPlus)
+        *p++ = '+';
+    if (spec.isSpace)
+        *p++ = ' ';
+    if (spec.isAlternate)
+        *p++ = '#';
+    *p++ = '*';
+    *p++ = '.';
+    *p++ = '*';
+    *p++ = spec.conversion;
+    *p = 0;
+
+    char buffer[48];
+    int length = snprintf(buffer, sizeof(buffer), fmt, spec.width, spec.precision, value.d);
+    if (length > 0)
+        out.put(buffer, length < (int)sizeof(buffer) ? length : sizeof(buffer) - 1);
+}
+
+static void putFloat(ChunkWriter &out, FormatSpec spec, const FormatValue &value)
+{
+    double d = value.d;
+    const char *sign = "";
+
+    if (signbit(d))
+    {
+        sign = "-";
+        d = -d;
+    }
+    else if (spec.isPlus)
+        sign = "+";
+    else if (spec.isSpace)
+        sign = " ";
+
+    if (isnan(d) || d > 1e18)
+    {
+        // NaN, infinity and numbers not fitting in 64 bits are rare
+        putFallback(out, spec, value);
+        return;
+    }
+
+    int precision = spec.precision < 0 ? 6 : spec.precision;
+    if (precision > 15)
+        precision = 15;
+
+    uint64_t scale = 1;
+    for (int i = 0; i < precision; i++)
+        scale *= 10;
+
+    uint64_t integral = (uint64_t)d;
+    double scaled = (d - integral) * scale;
+    uint64_t fraction = (uint64_t)scaled;
+
+    // rounding half to even, like printf; the multiplication could have
+    // been rounded to exactly half, so its error decides such cases
+    double rest = scaled - fraction;
+    if (rest == 0.5)
+    {
+        double error = fma(d - integral, (double)scale, -scaled);
+        uint64_t last = precision > 0 ? fraction : integral;
+        if (error > 0 || (error == 0 && (last & 1)))
+            fraction++;
+    }
+    else if (rest > 0.5)
+    {
+        fraction++;
+    }
+
+    if (fraction >= scale)
+    {
+        integral++;
+        fraction -= scale;
+    }
+
+    char buffer[40];
+    char *end = buffer + sizeof(buffer);
+    char *start = end;
+
+    if (precision > 0)
+    {
+        start = toDigits(end, fraction, 10, false);
+        while (end - start < precision)
+            *--start = '0';
+    }
+
+    if (precision > 0 || spec.isAlternate)
+        *--start = '.';
+
+    start = toDigits(start, integral, 10, false);
+
+    // precision was already applied to the digits
+    spec.precision = -1;
+    putNumber(out, spec, sign, start, end - start);
+}
+
+static void putString(ChunkWriter &out, const FormatSpec &spec, const char *str)
+{
+    size_t length = 0;
+    // with precision, the string is not read past it
+    while ((spec.precision < 0 || (int)length < spec.precision) && str[length] != 0)
+        length++;
+
+    int padding = spec.width - (int)length;
+
+    if (!spec.isLeft)
+        out.pad(' ', padding);
+
+    out.put(str, length);
+
+    if (spec.isLeft)
+        out.pad(' ', padding);
+}
+
+size_t MokoshFormat::format(MokoshFormatSink &sink, const char *fmt, va_list argptr)
+{
+    ChunkWriter out(sink);
+
+    va_list args;
+    va_copy(args, argptr);
+
+    const char *p = fmt;
+    while (*p != 0)
+    {
+        // copying the text up to the next conversion as a whole
+        const char *text = p;
+        while (*p != 0 && *p != '%')
+            p++;
+
+        if (p > text)
+            out.put(text, p - text);
+
+        if (*p == 0)
+            break;
+
+        const char *start = p++;
+        if (*p == '%')
+        {
+            out.put('%');
+            p++;
+            continue;
+        }
+
+        FormatSpec spec;
+        FormatValue value;
+        parseSpec(p, spec, args);
+
+        if (!readValue(spec, value, args))
+        {
+            // unknown conversion is written as it is
+            out.put(start, p - start);
+            continue;
+        }
+
+        switch (spec.conversion)
+        {
+        case 'c':
+        {
+            char c = (char)value.u;
+            spec.precision = -1;
+            putNumber(out, spec, "", &c, 1);
+            break;
+        }
+
+        case 's':
+            putString(out, spec, value.s);
+            break;
+
+        case 'f':
+        case 'F':
+            putFloat(out, spec, value);
+            break;
+
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            putFallback(out, spec, value);
+            break;
+
+        default:
+            putInteger(out, spec, value);
+            break;
+        }
+    }
+
+    va_end(args);
+    out.flush();
+
+    return out.getTotal();
+}
+
+uint32_t MokoshFormat::hash(const char *fmt, va_list argptr)
+{
+    uint32_t hash = MokoshHash::OFFSET_BASIS;
+
+    va_list args;
+    va_copy(args, argptr);
+
+    const char *p = fmt;
+    while (*p != 0)
+    {
+        if (*p++ != '%')
+            continue;
+
+        if (*p == '%')
+        {
+            p++;
+            continue;
+        }
+
+        FormatSpec spec;
+        FormatValue value;
+        parseSpec(p, spec, args);
+
+        if (!readValue(spec, value, args))
+            continue;
+
+        if (spec.conversion == 's')
+        {
+            // as when printed, the string does not need to be terminated
+            // if precision is given
+            for (int i = 0; (spec.precision < 0 || i < spec.precision) && value.s[i] != 0; i++)
+                hash = (hash ^ (uint8_t)value.s[i]) * MokoshHash::PRIME;
+        }
+        else
+        {
+            for (size_t i = 0; i < sizeof(value); i++)
+                hash = (hash ^ ((uint8_t *)&value)[i]) * MokoshHash::PRIME;
+        }
+    }
+
+    va_end(args);
+
+    return hash;
+}
@@ -0,0 +1,59 @@
+#ifndef MOKOSHFORMAT_H
+#define MOKOSHFORMAT_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// receives the formatted text in chunks
+class MokoshFormatSink
+{
+public:
+    // called with the next part of the text, not null-terminated
+    virtual void write(const char *chunk, size_t length) = 0;
+};
+
+// a sink which keeps the text in a fixed buffer, always null-terminated,
+// truncating what does not fit
+class MokoshBufferSink : public MokoshFormatSink
+{
+public:
+    MokoshBufferSink(char *buffer, size_t size) : buffer(buffer), size(size)
+    {
+        this->buffer[0] = 0;
+    }
+
+    virtual void write(const char *chunk, size_t length) override
+    {
+        if (this->length + length >= this->size)
+            length = this->size - this->length - 1;
+
+        memcpy(this->buffer + this->length, chunk, length);
+        this->length += length;
+        this->buffer[this->length] = 0;
+    }
+
+private:
+    char *buffer;
+    size_t size;
+    size_t length = 0;
+};
+
+// a small printf replacement for the log messages, which writes the text
+// in chunks to a sink, so messages of any length do not need a buffer
+//
+// supported are %d %i %u %x %X %o %c %s %p %f %% with flags (- + space 0 #),
+// width, precision and length modifiers (l, ll, h, z), other conversions
+// (like %e or %g) are passed to snprintf
+class MokoshFormat
+{
+public:
+    // formats the message and writes it to the sink, returns its length
+    static size_t format(MokoshFormatSink &sink, const char *fmt, va_list args);
+
+    // calculates hash of the values of the arguments (and strings they
+    // point to), the same arguments give the same message, but without
+    // formatting it
+    static uint32_t hash(const char *fmt, va_list args);
+};
+
+#endif
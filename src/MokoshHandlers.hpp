@@ -5,6 +5,8 @@ typedef std::function<void(String, String)> THandlerFunction_Command;
 
 typedef std::function<void(int)> THandlerFunction_MokoshError;
 
+typedef std::function<void(unsigned long)> THandlerFunction_Idle;
+
 class MokoshWiFiHandlers
 {
 public:
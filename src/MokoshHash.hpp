@@ -0,0 +1,102 @@
+#ifndef MOKOSHHASH_H
+#define MOKOSHHASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// FNV-1a hashing of strings, usable both at compile time (constexpr)
+// and at runtime, with the same results
+namespace MokoshHash
+{
+    static const uint32_t OFFSET_BASIS = 2166136261u;
+    static const uint32_t PRIME = 16777619u;
+
+    // calculates hash of a null-terminated string, intended for compile time
+    constexpr uint32_t fnv1a(const char *str, uint32_t hash = OFFSET_BASIS)
+    {
+        return *str == 0 ? hash : fnv1a(str + 1, (hash ^ (uint8_t)*str) * PRIME);
+    }
+
+    // calculates hash of a null-terminated string
+    inline uint32_t hash(const char *str)
+    {
+        uint32_t hash = OFFSET_BASIS;
+        while (*str != 0)
+        {
+            hash ^= (uint8_t)*str++;
+            hash *= PRIME;
+        }
+
+        return hash;
+    }
+
+    // calculates hash of a string of a given length
+    inline uint32_t hash(const char *str, size_t length)
+    {
+        uint32_t hash = OFFSET_BASIS;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= (uint8_t)str[i];
+            hash *= PRIME;
+        }
+
+        return hash;
+    }
+
+    constexpr const char *basenameFrom(const char *path, const char *last)
+    {
+        return *path == 0 ? last : basenameFrom(path + 1, (*path == '/' || *path == '\\') ? path + 1 : last);
+    }
+
+    // returns the part of a path after the last separator, at compile time
+    constexpr const char *basename(const char *path)
+    {
+        return basenameFrom(path, path);
+    }
+
+    // returns the position of the part of a path after the last separator
+    constexpr size_t basenameOffset(const char *path)
+    {
+        return basename(path) - path;
+    }
+
+    // a string stored by value, so it can be built during compilation
+    template <size_t N>
+    struct FixedString
+    {
+        char value[N];
+    };
+
+#if __cplusplus >= 201402L
+    // copies a string of a given length (with null terminator) during
+    // compilation, so only the copy is stored in flash
+    template <size_t N>
+    constexpr FixedString<N> copyString(const char *str)
+    {
+        FixedString<N> result{};
+        for (size_t i = 0; i < N - 1; i++)
+        {
+            result.value[i] = str[i];
+        }
+
+        return result;
+    }
+
+    // returns a short file identifier, '#' with the hash of the file name
+    // in hex, which can be resolved back by tools/mokosh_logdecode.py
+    constexpr FixedString<10> fileId(uint32_t hash)
+    {
+        FixedString<10> result{};
+        result.value[0] = '#';
+        for (int i = 0; i < 8; i++)
+        {
+            uint8_t digit = (hash >> (28 - 4 * i)) & 0xF;
+            result.value[i + 1] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        }
+
+        return result;
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef MOKOSHLOGQUEUE_H
+#define MOKOSHLOGQUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <memory>
+
+#include "MokoshLogger.hpp"
+#include "MokoshMutex.hpp"
+
+// maximum length of a message stored in the asynchronous log queue,
+// longer messages are truncated
+#if !defined(MOKOSH_LOG_RECORD_SIZE)
+#define MOKOSH_LOG_RECORD_SIZE 128
+#endif
+
+// what to do when the asynchronous log queue is full
+typedef enum LogOverflowPolicy
+{
+    // the oldest record waiting in the queue is removed
+    DROP_OLDEST = 0,
+
+    // the new record is not added to the queue
+    DROP_NEWEST = 1
+} LogOverflowPolicy;
+
+// a single log message waiting in the queue to be passed to the loggers
+struct MokoshLogRecord
+{
+    LogLevel level;
+    bool isTagged;
+
+    // the logger which was writing out messages when this one was logged,
+    // e.g. by publishing them, it is not passed back to it
+    MokoshLogger *writer;
+
+    const char *func;
+    const char *file;
+    int line;
+    long time;
+    char msg[MOKOSH_LOG_RECORD_SIZE];
+};
+
+// fixed-capacity ring buffer of log records, for many producers (code
+// calling mlog macros in any task) and one consumer (Mokosh::loop() or
+// a drain task); it is not lock-free, the producers take turns on a mutex,
+// so it must not be used from interrupts, only the consumer does not lock
+//
+// the capacity is rounded up to a power of two, at least 1, so the slots
+// stay in order when the 32-bit positions wrap around
+class MokoshLogQueue
+{
+public:
+    MokoshLogQueue(size_t capacity, LogOverflowPolicy policy = LogOverflowPolicy::DROP_OLDEST)
+        : capacity(MokoshLogQueue::roundUp(capacity)), policy(policy)
+    {
+        this->records.reset(new MokoshLogRecord[this->capacity]);
+    }
+
+    // copies the message into the queue, returns false if it was dropped
+    bool push(LogLevel level, bool isTagged, MokoshLogger *writer, const char *func, const char *file, int line, long time, const char *msg)
+    {
+        // the slot is taken and filled by one producer at a time
+        MokoshLock lock(this->producerMutex);
+
+        uint32_t h = this->head.load(std::memory_order_relaxed);
+        uint32_t t = this->tail.load(std::memory_order_acquire);
+
+        while (h - t >= this->capacity)
+        {
+            if (this->policy == LogOverflowPolicy::DROP_NEWEST)
+            {
+                this->dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // taking the oldest record from the consumer, if consumer was
+            // faster, t is reloaded and there may be a free slot now
+            if (this->tail.compare_exchange_weak(t, t + 1, std::memory_order_acq_rel))
+            {
+                this->dropped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+        }
+
+        MokoshLogRecord &record = this->records[h & (this->capacity - 1)];
+        record.level = level;
+        record.isTagged = isTagged;
+        record.writer = writer;
+        record.func = func;
+        record.file = file;
+        record.line = line;
+        record.time = time;
+        strncpy(record.msg, msg, MOKOSH_LOG_RECORD_SIZE - 1);
+        record.msg[MOKOSH_LOG_RECORD_SIZE - 1] = 0;
+
+        this->head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // copies the oldest record out of the queue, returns false if the
+    // queue is empty
+    bool pop(MokoshLogRecord &out)
+    {
+        uint32_t t = this->tail.load(std::memory_order_acquire);
+        while (t != this->head.load(std::memory_order_acquire))
+        {
+            out = this->records[t & (this->capacity - 1)];
+
+            // if the producer dropped this record while it was copied, the
+            // copy may be torn and is discarded, t is reloaded
+            if (this->tail.compare_exchange_strong(t, t + 1, std::memory_order_acq_rel))
+                return true;
+        }
+
+        return false;
+    }
+
+    // returns number of records waiting in the queue
+    size_t size()
+    {
+        return this->head.load(std::memory_order_acquire) - this->tail.load(std::memory_order_acquire);
+    }
+
+    // returns number of records dropped because the queue was full
+    uint32_t getDropped()
+    {
+        return this->dropped.load(std::memory_order_relaxed);
+    }
+
+    // returns number of records the queue can keep
+    size_t getCapacity()
+    {
+        return this->capacity;
+    }
+
+private:
+    // returns the smallest power of two not less than capacity, at most 2^31
+    static size_t roundUp(size_t capacity)
+    {
+        size_t rounded = 1;
+        while (rounded < capacity && rounded < ((size_t)1 << 31))
+            rounded <<= 1;
+
+        return rounded;
+    }
+
+    size_t capacity;
+    LogOverflowPolicy policy;
+    std::unique_ptr<MokoshLogRecord[]> records;
+
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+
+    MokoshMutex producerMutex;
+};
+
+#endif
@@ -1,8 +1,15 @@
 #ifndef DEBUGADAPTER_H
 #define DEBUGADAPTER_H
 
+#include <memory>
 #include "MokoshService.hpp"
 
+// maximum length of a message passed to log() of the loggers which do not
+// override logBegin(), logWrite() and logEnd(), longer messages are truncated
+#if !defined(MOKOSH_LOG_LINE_SIZE)
+#define MOKOSH_LOG_LINE_SIZE 256
+#endif
+
 // Debug level - starts from 0 to 6, higher is more severe
 typedef enum LogLevel
 {
@@ -21,8 +28,61 @@ public:
     // logs the message to the logger
     // the message consists of the level, function it was called in, filename with line number, time
     // and the actual message
+    // messages below the logger level are not passed, unless a level is set
+    // for their tag
     virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) = 0;
 
+    // starts a formatted message, which is then passed in chunks to
+    // logWrite() and finished by logEnd(), so the message does not need to
+    // be kept in a buffer; by default the chunks are collected in a line of
+    // MOKOSH_LOG_LINE_SIZE and passed to log()
+    virtual void logBegin(LogLevel level, const char *func, const char *file, int line, long time)
+    {
+        if (this->pendingMsg == nullptr)
+            this->pendingMsg.reset(new char[MOKOSH_LOG_LINE_SIZE]);
+
+        this->pending = {level, func, file, line, time, 0};
+        this->pendingMsg[0] = 0;
+    }
+
+    // passes the next part of the message started by logBegin()
+    virtual void logWrite(const char *chunk, size_t length)
+    {
+        if (this->pending.length + length >= MOKOSH_LOG_LINE_SIZE)
+            length = MOKOSH_LOG_LINE_SIZE - this->pending.length - 1;
+
+        memcpy(this->pendingMsg.get() + this->pending.length, chunk, length);
+        this->pending.length += length;
+        this->pendingMsg[this->pending.length] = 0;
+    }
+
+    // finishes the message started by logBegin()
+    virtual void logEnd()
+    {
+        this->log(this->pending.level, this->pending.func, this->pending.file, this->pending.line, this->pending.time, this->pendingMsg.get());
+    }
+
+    // returns if the logger is writing out the messages now, e.g. publishing
+    // them; the messages logged meanwhile are not passed to it later by
+    // asynchronous logging, as they would be written out again
+    virtual bool isWriting()
+    {
+        return false;
+    }
+
+    // returns if the logger wants messages formatted and passed to log(),
+    // or the format string with its arguments passed to logRaw()
+    virtual bool isFormatting()
+    {
+        return true;
+    }
+
+    // logs the message which is not formatted, used only if isFormatting()
+    // returns false
+    virtual void logRaw(LogLevel level, const char *func, const char *file, int line, long time, const char *fmt, va_list args)
+    {
+    }
+
     // logs that the long operation is in progress
     virtual void ticker_step() = 0;
 
@@ -42,7 +102,21 @@ public:
     }
 
 protected:
-    LogLevel currentLevel;
+    LogLevel currentLevel = LogLevel::PROFILER;
+
+    // the message being passed in chunks, when logBegin() is not overridden
+    struct PendingMessage
+    {
+        LogLevel level;
+        const char *func;
+        const char *file;
+        int line;
+        long time;
+        size_t length;
+    };
+
+    PendingMessage pending = {};
+    std::unique_ptr<char[]> pendingMsg;
 
     virtual char levelToChar(LogLevel level)
     {
@@ -83,15 +157,35 @@ public:
 
     virtual void loop() override {}
 
-    virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) override
+    // the messages are printed when they are logged
+    virtual unsigned long getPollInterval() override
     {
-        if (level < this->currentLevel)
-            return;
+        return MokoshService::POLL_NEVER;
+    }
 
+    virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) override
+    {
         char lvl = this->levelToChar(level);
         Serial.printf("(%c t:%ldms) (%s %s:%d) %s\n", lvl, time, func, file, line, msg);
     }
 
+    // the message is printed directly, without collecting it first
+    virtual void logBegin(LogLevel level, const char *func, const char *file, int line, long time) override
+    {
+        char lvl = this->levelToChar(level);
+        Serial.printf("(%c t:%ldms) (%s %s:%d) ", lvl, time, func, file, line);
+    }
+
+    virtual void logWrite(const char *chunk, size_t length) override
+    {
+        Serial.write((const uint8_t *)chunk, length);
+    }
+
+    virtual void logEnd() override
+    {
+        Serial.print("\n");
+    }
+
     virtual void ticker_step() override
     {
         Serial.print(".");
@@ -0,0 +1,76 @@
+#ifndef MOKOSHLOOPSTATS_H
+#define MOKOSHLOOPSTATS_H
+
+#include <Arduino.h>
+
+// number of buckets of the loop duration histogram, bucket n counts the
+// iterations taking from 2^(n-1) to 2^n - 1 microseconds, and the last one
+// also all the longer ones
+#if !defined(MOKOSH_LOOP_HISTOGRAM_SIZE)
+#define MOKOSH_LOOP_HISTOGRAM_SIZE 20
+#endif
+
+// the parts of a single Mokosh::loop() iteration
+typedef enum MokoshLoopPhase
+{
+    PHASE_TIMERS = 0,
+    PHASE_TASKS = 1,
+    PHASE_JOBS = 2,
+    PHASE_RECONNECT = 3,
+    PHASE_SERVICES = 4,
+    PHASE_LOGS = 5,
+    PHASE_SETUP = 6,
+    PHASE_COUNT = 7
+} MokoshLoopPhase;
+
+// duration statistics of Mokosh::loop() iterations (without the idle sleep),
+// all times in microseconds, kept in fixed-size storage
+struct MokoshLoopStats
+{
+    uint32_t count = 0;
+    unsigned long maxDuration = 0;
+    uint64_t totalDuration = 0;
+
+    uint32_t histogram[MOKOSH_LOOP_HISTOGRAM_SIZE] = {0};
+
+    // time spent in every phase of the loop
+    uint64_t phaseDuration[PHASE_COUNT] = {0};
+
+    // adds time since a given moment to the phase, returns the current time,
+    // so the next phase can be measured from it
+    unsigned long lap(MokoshLoopPhase phase, unsigned long since)
+    {
+        unsigned long now = micros();
+        this->phaseDuration[phase] += now - since;
+        return now;
+    }
+
+    // records duration of a whole iteration
+    void record(unsigned long duration)
+    {
+        this->count++;
+        this->totalDuration += duration;
+        if (duration > this->maxDuration)
+            this->maxDuration = duration;
+
+        this->histogram[MokoshLoopStats::getBucket(duration)]++;
+    }
+
+    // returns the histogram bucket for a given duration: the number of its
+    // significant bits, a single instruction on most cores
+    static int getBucket(unsigned long duration)
+    {
+        if (duration == 0)
+            return 0;
+
+        int bits = (int)(sizeof(duration) * 8) - __builtin_clzl(duration);
+        return bits < MOKOSH_LOOP_HISTOGRAM_SIZE ? bits : MOKOSH_LOOP_HISTOGRAM_SIZE - 1;
+    }
+
+    void reset()
+    {
+        *this = MokoshLoopStats();
+    }
+};
+
+#endif
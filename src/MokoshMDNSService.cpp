@@ -24,11 +24,20 @@ namespace MokoshServices
             return false;
         }
 
+        this->setupFinished = true;
+
         this->addMDNSService("mokosh", "tcp", 23);
         this->addMDNSServiceProps("mokosh", "tcp", "version", mokosh->getVersion().c_str());
 
-        this->setupFinished = true;
+        for (auto &entry : this->pending)
+        {
+            if (entry.property == "")
+                this->addMDNSService(entry.service.c_str(), entry.proto.c_str(), entry.port);
+            else
+                this->addMDNSServiceProps(entry.service.c_str(), entry.proto.c_str(), entry.property.c_str(), entry.value.c_str());
+        }
 
+        this->pending.clear();
         return true;
     }
 
@@ -39,11 +48,23 @@ namespace MokoshServices
 
     void MDNSService::addMDNSService(const char *service, const char *proto, uint16_t port)
     {
+        if (!this->setupFinished)
+        {
+            this->pending.push_back({service, proto, port, "", ""});
+            return;
+        }
+
         MDNS.addService(service, proto, port);
     }
 
     void MDNSService::addMDNSServiceProps(const char *service, const char *proto, const char *property, const char *value)
     {
+        if (!this->setupFinished)
+        {
+            this->pending.push_back({service, proto, 0, property, value});
+            return;
+        }
+
         MDNS.addServiceTxt(service, proto, property, value);
     }
 
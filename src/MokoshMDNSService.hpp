@@ -19,20 +19,45 @@ namespace MokoshServices
 
         virtual bool setup() override;
 
-        // adds broadcasted MDNS service
+        // adds broadcasted MDNS service, if it is not set up yet (the network
+        // is not connected), it is added when it is
         void addMDNSService(const char *service, const char *proto, uint16_t port);
 
-        // adds broadcasted MDNS service props
+        // adds broadcasted MDNS service props, if it is not set up yet, they
+        // are added when it is
         void addMDNSServiceProps(const char *service, const char *proto, const char *property, const char *value);
 
         virtual void loop() override;
 
+        // loop() is empty, so it is not run
+        virtual unsigned long getPollInterval() override
+        {
+            return MokoshService::POLL_NEVER;
+        }
+
         virtual std::vector<const char *> getDependencies() override
         {
             return {MokoshService::DEPENDENCY_NETWORK};
         }
 
+        // the key and the dependencies for MokoshStatic
+        static constexpr const char *STATIC_KEY = "MDNS";
+        static constexpr const char *STATIC_DEPENDENCIES[] = {"NET", nullptr};
+
         static const char *KEY;
+
+    private:
+        // a service or its property added before the setup
+        struct PendingEntry
+        {
+            String service;
+            String proto;
+            uint16_t port;
+            String property;
+            String value;
+        };
+
+        std::vector<PendingEntry> pending;
     };
 }
 
@@ -0,0 +1,3 @@
+#include "MokoshMqttLogger.hpp"
+
+const char *MqttLogger::KEY = "MQTT_DEBUG";
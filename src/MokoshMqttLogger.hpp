@@ -0,0 +1,177 @@
+#ifndef MOKOSHMQTTLOGGER_H
+#define MOKOSHMQTTLOGGER_H
+
+#include <Arduino.h>
+#include <memory>
+#include <Mokosh.hpp>
+
+// a logger which publishes log lines on the debug topic, lines are
+// collected in a buffer and published together when the buffer is full,
+// when the flush interval passes or immediately on error
+class MqttLogger : public MokoshLogger
+{
+public:
+    // the buffer must fit in a single MQTT packet together with the topic,
+    // so it should not be larger than the buffer size of the MQTT client
+    MqttLogger(size_t bufferSize = 192, unsigned long flushInterval = 5000)
+        : buffer(new char[bufferSize]), bufferSize(bufferSize), flushInterval(flushInterval)
+    {
+        this->buffer[0] = 0;
+    }
+
+    virtual bool setup() override
+    {
+        this->lastFlush = millis();
+        this->setupFinished = true;
+        return true;
+    }
+
+    virtual void loop() override
+    {
+        if (this->length > 0 && millis() - this->lastFlush >= this->flushInterval)
+            this->flush();
+    }
+
+    // loop() only checks if the buffer should be flushed
+    virtual unsigned long getPollInterval() override
+    {
+        return 100;
+    }
+
+    virtual const char *key() override
+    {
+        return MqttLogger::KEY;
+    }
+
+    virtual std::vector<const char *> getDependencies() override
+    {
+        return {MokoshService::DEPENDENCY_MQTT};
+    }
+
+    // the messages logged by publishing are not published, also when they
+    // are passed to the logger later, by asynchronous logging
+    virtual bool isWriting() override
+    {
+        return this->isPublishing;
+    }
+
+    virtual void log(LogLevel level, const char *func, const char *file, int line, long time, const char *msg) override
+    {
+        // anything else logged while publishing is ignored too
+        if (this->isPublishing)
+            return;
+
+        if (!this->append(level, func, file, line, time, msg))
+        {
+            // buffer is full, trying to make space for the line
+            if (!this->flush() || !this->append(level, func, file, line, time, msg))
+            {
+                this->droppedCount++;
+                return;
+            }
+        }
+
+        this->batchedCount++;
+
+        if (level >= LogLevel::ERROR)
+            this->flush();
+    }
+
+    virtual void ticker_step() override
+    {
+    }
+
+    virtual void ticker_finish(bool success) override
+    {
+    }
+
+    virtual void registerCommands(MokoshCommandRegistry &commands) override
+    {
+        commands.add(
+            "mqttlogstats", [this](MokoshStringView param)
+            {
+                char msg[96] = {0};
+                snprintf(msg, sizeof(msg) - 1, "{\"batched\": %lu, \"dropped\": %lu, \"flushes\": %lu}", this->batchedCount, this->droppedCount, this->flushCount);
+
+                auto mqtt = Mokosh::getInstance()->getMqttService();
+                if (mqtt != nullptr)
+                    mqtt->publish(Mokosh::getInstance()->debug_response_topic, msg);
+            },
+            "publishes the numbers of batched and dropped lines", this);
+    }
+
+    // publishes all buffered lines, returns false if they couldn't be
+    // published now and are still in the buffer
+    bool flush()
+    {
+        if (this->length == 0)
+            return true;
+
+        auto mqtt = Mokosh::getInstance()->getMqttService();
+        if (mqtt == nullptr || !mqtt->isConnected())
+            return false;
+
+        this->isPublishing = true;
+        mqtt->publish(Mokosh::getInstance()->debug_topic, this->buffer.get());
+        this->isPublishing = false;
+
+        this->length = 0;
+        this->buffer[0] = 0;
+        this->lastFlush = millis();
+        this->flushCount++;
+
+        return true;
+    }
+
+    // returns number of lines which were added to the buffer
+    unsigned long getBatchedCount()
+    {
+        return this->batchedCount;
+    }
+
+    // returns number of lines which were lost because the buffer was full
+    unsigned long getDroppedCount()
+    {
+        return this->droppedCount;
+    }
+
+    // returns number of published messages
+    unsigned long getFlushCount()
+    {
+        return this->flushCount;
+    }
+
+    static const char *KEY;
+
+private:
+    std::unique_ptr<char[]> buffer;
+    size_t bufferSize;
+    size_t length = 0;
+
+    unsigned long flushInterval;
+    unsigned long lastFlush = 0;
+
+    bool isPublishing = false;
+
+    unsigned long batchedCount = 0;
+    unsigned long droppedCount = 0;
+    unsigned long flushCount = 0;
+
+    bool append(LogLevel level, const char *func, const char *file, int line, long time, const char *msg)
+    {
+        size_t space = this->bufferSize - this->length;
+        int written = snprintf(this->buffer.get() + this->length, space, "(%c t:%ldms) (%s %s:%d) %s\n", this->levelToChar(level), time, func, file, line, msg);
+
+        if (written < 0 || (size_t)written >= space)
+        {
+            // the line does not fit, removing what was partially written
+            this->buffer[this->length] = 0;
+            return false;
+        }
+
+        this->length += written;
+        return true;
+    }
+};
+
+#endif
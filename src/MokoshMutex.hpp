@@ -0,0 +1,62 @@
+#ifndef MOKOSHMUTEX_H
+#define MOKOSHMUTEX_H
+
+#include <Arduino.h>
+
+// platforms where code may run in more than one thread at once, elsewhere
+// the mutex does nothing
+#if !defined(MOKOSH_THREADS)
+#if defined(ESP32) || defined(__unix__) || defined(__APPLE__)
+#define MOKOSH_THREADS 1
+#else
+#define MOKOSH_THREADS 0
+#endif
+#endif
+
+#if MOKOSH_THREADS
+#include <mutex>
+#endif
+
+// a mutex which can be locked again by the thread already holding it
+class MokoshMutex
+{
+public:
+    void lock()
+    {
+#if MOKOSH_THREADS
+        this->mutex.lock();
+#endif
+    }
+
+    void unlock()
+    {
+#if MOKOSH_THREADS
+        this->mutex.unlock();
+#endif
+    }
+
+private:
+#if MOKOSH_THREADS
+    std::recursive_mutex mutex;
+#endif
+};
+
+// locks the mutex until the end of the scope
+class MokoshLock
+{
+public:
+    MokoshLock(MokoshMutex &mutex) : mutex(mutex)
+    {
+        this->mutex.lock();
+    }
+
+    ~MokoshLock()
+    {
+        this->mutex.unlock();
+    }
+
+private:
+    MokoshMutex &mutex;
+};
+
+#endif
@@ -115,11 +115,21 @@ namespace MokoshServices
             return {MokoshService::DEPENDENCY_NETWORK};
         }
 
+        // the key and the dependencies for MokoshStatic
+        static constexpr const char *STATIC_KEY = "OTA";
+        static constexpr const char *STATIC_DEPENDENCIES[] = {"NET", nullptr};
+
         virtual void loop() override
         {
             ArduinoOTA.handle();
         }
 
+        // the update is received in loop(), so there is no sleeping during it
+        virtual unsigned long getMaxIdleTime() override
+        {
+            return this->isOTAInProgress ? 0 : 100;
+        }
+
         // event handlers for OTA situations (onStart, onEnd, etc.)
         MokoshOTAHandlers otaEvents;
 
@@ -0,0 +1,50 @@
+#include "MokoshProfiler.hpp"
+
+#if defined(ESP32) || defined(ESP8266)
+const char *MokoshProfiler::UNIT = "cycles";
+#else
+const char *MokoshProfiler::UNIT = "us";
+#endif
+
+MokoshProfilerEntry MokoshProfiler::entries[MOKOSH_PROFILER_SCOPES];
+int MokoshProfiler::count = 0;
+
+int MokoshProfiler::find(const char *name, bool isStatic)
+{
+    for (int i = 0; i < MokoshProfiler::count; i++)
+    {
+        if (MokoshProfiler::entries[i].key == name)
+            return i;
+    }
+
+    for (int i = 0; i < MokoshProfiler::count; i++)
+    {
+        if (strncmp(MokoshProfiler::entries[i].name, name, MOKOSH_PROFILER_NAME_SIZE - 1) == 0)
+            return i;
+    }
+
+    if (MokoshProfiler::count >= MOKOSH_PROFILER_SCOPES)
+        return -1;
+
+    MokoshProfilerEntry &entry = MokoshProfiler::entries[MokoshProfiler::count];
+    strncpy(entry.name, name, MOKOSH_PROFILER_NAME_SIZE - 1);
+    entry.name[MOKOSH_PROFILER_NAME_SIZE - 1] = 0;
+    entry.key = isStatic ? name : nullptr;
+    entry.count = 0;
+    entry.total = 0;
+    entry.min = UINT32_MAX;
+    entry.max = 0;
+
+    return MokoshProfiler::count++;
+}
+
+void MokoshProfiler::reset()
+{
+    for (int i = 0; i < MokoshProfiler::count; i++)
+    {
+        MokoshProfiler::entries[i].count = 0;
+        MokoshProfiler::entries[i].total = 0;
+        MokoshProfiler::entries[i].min = UINT32_MAX;
+        MokoshProfiler::entries[i].max = 0;
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef MOKOSHPROFILER_H
+#define MOKOSHPROFILER_H
+
+#include <Arduino.h>
+
+// set to 0 to compile the profiler out, profile scopes are then empty
+#if !defined(MOKOSH_PROFILER)
+#define MOKOSH_PROFILER 1
+#endif
+
+// maximum number of profiled scopes, scopes over the limit are not measured
+#if !defined(MOKOSH_PROFILER_SCOPES)
+#define MOKOSH_PROFILER_SCOPES 24
+#endif
+
+// maximum length of a scope name (with null terminator), longer names
+// are truncated
+#define MOKOSH_PROFILER_NAME_SIZE 16
+
+// statistics of a single profiled scope, durations are in MokoshProfiler::UNIT
+struct MokoshProfilerEntry
+{
+    char name[MOKOSH_PROFILER_NAME_SIZE];
+    const char *key;
+    uint32_t count;
+    uint64_t total;
+    uint32_t min;
+    uint32_t max;
+};
+
+// a fixed-size table of call count and duration statistics of code scopes,
+// measured using the CPU cycle counter (on ESP) or micros() (elsewhere);
+// nothing is allocated when the scopes are measured
+class MokoshProfiler
+{
+public:
+    // unit of the measured durations, "cycles" or "us"
+    static const char *UNIT;
+
+    // returns current value of the time source
+    static inline uint32_t now()
+    {
+#if defined(ESP32) || defined(ESP8266)
+        return ESP.getCycleCount();
+#else
+        return micros();
+#endif
+    }
+
+    // returns the slot of a scope of a given name, adding it to the table if
+    // it is not there yet, or -1 if the table is full; if name is static
+    // (like a literal), the pointer is remembered for faster lookups
+    static int find(const char *name, bool isStatic = true);
+
+    // adds a single measurement to the scope in a given slot
+    static inline void record(int slot, uint32_t duration)
+    {
+        if (slot < 0)
+            return;
+
+        MokoshProfilerEntry &entry = MokoshProfiler::entries[slot];
+        entry.count++;
+        entry.total += duration;
+
+        if (duration < entry.min)
+            entry.min = duration;
+        if (duration > entry.max)
+            entry.max = duration;
+    }
+
+    // clears the statistics, scopes keep their slots
+    static void reset();
+
+    // returns number of scopes in the table
+    static int getCount()
+    {
+        return MokoshProfiler::count;
+    }
+
+    // returns statistics of the scope in a given slot
+    static const MokoshProfilerEntry &getEntry(int slot)
+    {
+        return MokoshProfiler::entries[slot];
+    }
+
+private:
+    static MokoshProfilerEntry entries[MOKOSH_PROFILER_SCOPES];
+    static int count;
+};
+
+// measures the time from its construction to its destruction and records
+// it in the profiler
+class MokoshProfileScope
+{
+public:
+    MokoshProfileScope(int slot) : slot(slot), start(MokoshProfiler::now())
+    {
+    }
+
+    ~MokoshProfileScope()
+    {
+        MokoshProfiler::record(this->slot, MokoshProfiler::now() - this->start);
+    }
+
+private:
+    int slot;
+    uint32_t start;
+};
+
+#define MOKOSH_PROFILE_CONCAT2(a, b) a##b
+#define MOKOSH_PROFILE_CONCAT(a, b) MOKOSH_PROFILE_CONCAT2(a, b)
+
+#if MOKOSH_PROFILER
+// measures the rest of the current block, name must be a literal; the slot
+// is found only once, on the first run
+#define MOKOSH_PROFILE_SCOPE(name)                                                                       \
+    static const int MOKOSH_PROFILE_CONCAT(_mokosh_profile_slot, __LINE__) = MokoshProfiler::find(name); \
+    MokoshProfileScope MOKOSH_PROFILE_CONCAT(_mokosh_profile_scope, __LINE__)(MOKOSH_PROFILE_CONCAT(_mokosh_profile_slot, __LINE__))
+#else
+#define MOKOSH_PROFILE_SCOPE(name)
+#endif
+
+#endif
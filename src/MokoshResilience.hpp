@@ -36,34 +36,71 @@ namespace MokoshResilience
         int counter = 0;
     };
 
-    // class for retrying things with delay between trials
-    class Retry
+    // task retrying an operation with delay between trials, without blocking
+    // the loop
+    class RetryTask : public MokoshTask
     {
     public:
         // will retry the operation if returned false, each time delaying it
-        // a bit longer, until the name of trials is being exceeded
-        static bool retry(std::function<bool(void)> operation, int trials = 3, long delayTime = 100, int delayFactor = 2)
+        // a bit longer, until the number of trials is exceeded, then calls
+        // onFinished (if set) with the result
+        RetryTask(std::function<bool(void)> operation, std::function<void(bool)> onFinished = nullptr, int trials = 3, long delayTime = 100, int delayFactor = 2)
+        {
+            this->operation = operation;
+            this->onFinished = onFinished;
+            this->trials = trials;
+            this->delayTime = delayTime;
+            this->delayFactor = delayFactor;
+        }
+
+        // returns if the operation has succeeded
+        bool isSuccess()
+        {
+            return this->success;
+        }
+
+    protected:
+        virtual bool run() override
         {
-            int i = 0;
-            while (i < trials)
+            MOKOSH_TASK_BEGIN();
+
+            for (this->trial = 0; this->trial < this->trials;)
             {
-                if (operation())
-                    return true;
+                if (this->operation())
+                {
+                    this->success = true;
+                    break;
+                }
 
-                long time = delayTime * power(delayFactor, i + 1);
-                i++;
-                if (i >= trials)
+                this->time = this->delayTime * RetryTask::power(this->delayFactor, this->trial + 1);
+                this->trial++;
+                if (this->trial >= this->trials)
                     break;
 
-                mlogV("Resilience operation failed, retrying in %d", time);
-                delay(time);
+                mlogV("Resilience operation failed, retrying in %d", this->time);
+                MOKOSH_TASK_SLEEP(this->time);
             }
 
-            mlogV("Resilience operation failed after %d trials, giving up!", trials);
-            return false;
+            if (!this->success)
+                mlogV("Resilience operation failed after %d trials, giving up!", this->trials);
+
+            if (this->onFinished != nullptr)
+                this->onFinished(this->success);
+
+            MOKOSH_TASK_END();
         }
 
     private:
+        std::function<bool(void)> operation;
+        std::function<void(bool)> onFinished;
+        int trials = 3;
+        long delayTime = 100;
+        int delayFactor = 2;
+
+        int trial = 0;
+        long time = 0;
+        bool success = false;
+
         static long power(int base, int exponent)
         {
             if (exponent == 0)
@@ -80,6 +117,33 @@ namespace MokoshResilience
         }
     };
 
+    // class for retrying things with delay between trials
+    class Retry
+    {
+    public:
+        // will retry the operation if returned false, each time delaying it
+        // a bit longer, until the name of trials is being exceeded
+        // blocks until finished, so should be used only before the loop
+        // starts, retryAsync() is preferred later
+        static bool retry(std::function<bool(void)> operation, int trials = 3, long delayTime = 100, int delayFactor = 2)
+        {
+            RetryTask task(operation, nullptr, trials, delayTime, delayFactor);
+            task.join();
+
+            return task.isSuccess();
+        }
+
+        // the same as retry(), but the trials are run by Mokosh::loop()
+        // and the result is passed to onFinished
+        static std::shared_ptr<RetryTask> retryAsync(std::function<bool(void)> operation, std::function<void(bool)> onFinished = nullptr, int trials = 3, long delayTime = 100, int delayFactor = 2)
+        {
+            auto task = std::make_shared<RetryTask>(operation, onFinished, trials, delayTime, delayFactor);
+            Mokosh::getInstance()->startTask(task);
+
+            return task;
+        }
+    };
+
 }
 
 #endif
\ No newline at end of file
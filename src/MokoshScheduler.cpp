@@ -0,0 +1,443 @@
+#include "MokoshScheduler.hpp"
+
+void MokoshTimer::cancel()
+{
+    if (this->scheduler != nullptr && this->scheduler->isValid(this->slot, this->generation))
+        this->scheduler->release(this->slot);
+}
+
+void MokoshTimer::pause()
+{
+    if (!this->isRunning())
+        return;
+
+    auto &timer = this->scheduler->timers[this->slot];
+    long remaining = (long)(timer.deadline - millis());
+    timer.remaining = remaining > 0 ? remaining : 0;
+
+    this->scheduler->stop(this->slot);
+}
+
+void MokoshTimer::resume()
+{
+    if (!this->isActive() || this->scheduler->timers[this->slot].isRunning)
+        return;
+
+    this->scheduler->start(this->slot, this->scheduler->timers[this->slot].remaining);
+}
+
+void MokoshTimer::restart()
+{
+    if (!this->isActive())
+        return;
+
+    this->scheduler->timers[this->slot].runCount = 0;
+    this->scheduler->start(this->slot, this->scheduler->timers[this->slot].interval);
+}
+
+void MokoshTimer::setPeriod(unsigned long period)
+{
+    if (!this->isActive())
+        return;
+
+    auto &timer = this->scheduler->timers[this->slot];
+    timer.interval = period;
+    timer.remaining = period;
+
+    if (timer.isRunning)
+        this->scheduler->start(this->slot, period);
+}
+
+unsigned long MokoshTimer::getPeriod()
+{
+    if (!this->isActive())
+        return 0;
+
+    return this->scheduler->timers[this->slot].interval;
+}
+
+void MokoshTimer::setCatchUpPolicy(TimerCatchUpPolicy policy)
+{
+    if (this->isActive())
+        this->scheduler->timers[this->slot].policy = policy;
+}
+
+#if MOKOSH_TIMER_STATS
+const MokoshTimerStats *MokoshTimer::getStats()
+{
+    if (!this->isActive())
+        return nullptr;
+
+    return &this->scheduler->timers[this->slot].stats;
+}
+
+void MokoshTimer::resetStats()
+{
+    if (this->isActive())
+        memset(&this->scheduler->timers[this->slot].stats, 0, sizeof(MokoshTimerStats));
+}
+#endif
+
+void MokoshTimer::setBudget(unsigned long budget, bool isDemotable)
+{
+    if (!this->isActive())
+        return;
+
+    auto &timer = this->scheduler->timers[this->slot];
+    timer.execution.budget = budget;
+    timer.isDemotable = isDemotable;
+    if (!isDemotable)
+        timer.demotion = 0;
+}
+
+const MokoshExecutionStats *MokoshTimer::getExecutionStats()
+{
+    if (!this->isActive())
+        return nullptr;
+
+    return &this->scheduler->timers[this->slot].execution;
+}
+
+void MokoshTimer::resetExecutionStats()
+{
+    if (this->isActive())
+        this->scheduler->timers[this->slot].execution.reset();
+}
+
+int MokoshTimer::getDemotion()
+{
+    if (!this->isActive())
+        return 0;
+
+    return this->scheduler->timers[this->slot].demotion;
+}
+
+bool MokoshTimer::isActive()
+{
+    return this->scheduler != nullptr && this->scheduler->isValid(this->slot, this->generation);
+}
+
+bool MokoshTimer::isRunning()
+{
+    return this->isActive() && this->scheduler->timers[this->slot].isRunning;
+}
+
+MokoshTimer MokoshScheduler::add(fptr func, unsigned long interval, int runs, bool start)
+{
+    size_t slot;
+    if (!this->freeSlots.empty())
+    {
+        slot = this->freeSlots.back();
+        this->freeSlots.pop_back();
+    }
+    else
+    {
+        slot = this->timers.size();
+        this->timers.emplace_back();
+        this->timers[slot].generation = 0;
+    }
+
+    Timer &timer = this->timers[slot];
+    timer.func = func;
+    timer.interval = interval;
+    timer.scheduled = 0;
+    timer.deadline = 0;
+    timer.remaining = interval;
+    timer.lastRunTime = 0;
+    timer.runs = runs;
+    timer.runCount = 0;
+    timer.policy = TimerCatchUpPolicy::RUN_MISSED_ONCE;
+    timer.execution = MokoshExecutionStats();
+    timer.demotion = 0;
+    timer.isDemotable = false;
+    timer.isUsed = true;
+    timer.isRunning = false;
+    timer.hasRun = false;
+    timer.heapIndex = 0;
+#if MOKOSH_TIMER_STATS
+    memset(&timer.stats, 0, sizeof(MokoshTimerStats));
+#endif
+
+    if (start)
+        this->start(slot, interval);
+
+    return MokoshTimer(this, slot, timer.generation);
+}
+
+void MokoshScheduler::startAll()
+{
+    for (size_t slot = 0; slot < this->timers.size(); slot++)
+    {
+        if (!this->timers[slot].isUsed)
+            continue;
+
+        this->timers[slot].runCount = 0;
+        this->start(slot, this->timers[slot].interval);
+    }
+}
+
+int MokoshScheduler::update()
+{
+    unsigned long now = millis();
+    int count = 0;
+
+    // a function restarting its timer with zero interval could make it run
+    // forever, so at most every timer is run once
+    size_t limit = this->heap.size();
+
+    while (!this->heap.empty() && (size_t)count < limit)
+    {
+        size_t slot = this->heap[0];
+        Timer &timer = this->timers[slot];
+
+        if (MokoshScheduler::isBefore(now, timer.deadline))
+            break;
+
+        count++;
+
+        // number of whole periods the timer is late
+        unsigned long period = MokoshScheduler::getPeriod(timer);
+        unsigned long lateness = now - timer.scheduled;
+        unsigned long missed = period > 0 ? lateness / period : 0;
+
+        if (missed > 0 && timer.policy == TimerCatchUpPolicy::SKIP_MISSED)
+        {
+            // even the current run is too late, so the timer waits for the
+            // next period in its phase
+            timer.scheduled += (missed + 1) * period;
+            timer.deadline = timer.scheduled;
+#if MOKOSH_TIMER_STATS
+            timer.stats.missedCount += missed + 1;
+#endif
+            this->siftDown(0);
+            continue;
+        }
+
+#if MOKOSH_TIMER_STATS
+        if (timer.policy == TimerCatchUpPolicy::RUN_MISSED_ONCE)
+            timer.stats.missedCount += missed;
+
+        this->recordRun(timer, now, lateness);
+#endif
+        timer.lastRunTime = now;
+        timer.hasRun = true;
+
+        // rescheduling before the run, so the function may stop or restart
+        // its own timer
+        timer.runCount++;
+        if (timer.runs > 0 && timer.runCount >= timer.runs)
+        {
+            // the last run, the slot is released before, and the function
+            // is destroyed after it has finished
+            fptr func = std::move(timer.func);
+            this->release(slot);
+            func();
+
+            continue;
+        }
+
+        // the next deadline is counted from the previous one, so the timer
+        // keeps its phase; zero interval is treated as one from now, so the
+        // timer does not run over and over in the same update
+        if (period == 0)
+            timer.scheduled = now + 1;
+        else if (timer.policy == TimerCatchUpPolicy::RUN_ALL_MISSED)
+            timer.scheduled += period;
+        else
+            timer.scheduled += (missed + 1) * period;
+
+        // the missed runs are not run all at once
+        timer.deadline = MokoshScheduler::isBefore(now, timer.scheduled) ? timer.scheduled : now + 1;
+
+        this->siftDown(0);
+
+        this->currentSlot = slot;
+        this->isCurrentCancelled = false;
+
+        unsigned long startTime = micros();
+        timer.func();
+        unsigned long duration = micros() - startTime;
+
+        this->currentSlot = NONE;
+        this->recordExecution(slot, duration);
+
+        if (this->isCurrentCancelled)
+            this->release(slot);
+    }
+
+    return count;
+}
+
+unsigned long MokoshScheduler::getTimeToNext()
+{
+    if (this->heap.empty())
+        return ULONG_MAX;
+
+    long time = (long)(this->timers[this->heap[0]].deadline - millis());
+    return time > 0 ? time : 0;
+}
+
+#if MOKOSH_TIMER_STATS
+void MokoshScheduler::recordRun(Timer &timer, unsigned long now, unsigned long lateness)
+{
+    timer.stats.runCount++;
+    timer.stats.lateness[MokoshScheduler::getBucket(lateness)]++;
+    if (lateness > timer.stats.maxLateness)
+        timer.stats.maxLateness = lateness;
+
+    if (timer.hasRun)
+    {
+        unsigned long period = MokoshScheduler::getPeriod(timer);
+        unsigned long elapsed = now - timer.lastRunTime;
+        unsigned long jitter = elapsed > period ? elapsed - period : period - elapsed;
+        timer.stats.jitter[MokoshScheduler::getBucket(jitter)]++;
+    }
+}
+#endif
+
+void MokoshScheduler::recordExecution(size_t slot, unsigned long duration)
+{
+    Timer &timer = this->timers[slot];
+
+    if (!timer.execution.record(duration))
+    {
+        if (timer.demotion > 0)
+            timer.demotion--;
+
+        return;
+    }
+
+    if (timer.isDemotable && timer.demotion < MokoshScheduler::MAX_DEMOTION && timer.execution.consecutiveOverruns >= MOKOSH_OVERRUN_DEMOTE_LIMIT)
+    {
+        timer.demotion++;
+        timer.execution.consecutiveOverruns = 0;
+    }
+
+    if (this->onOverrun != nullptr)
+    {
+        MokoshTimer handle(this, slot, timer.generation);
+        this->onOverrun(handle, duration);
+    }
+}
+
+void MokoshScheduler::start(size_t slot, unsigned long delay)
+{
+    Timer &timer = this->timers[slot];
+    timer.scheduled = millis() + delay;
+    timer.deadline = timer.scheduled;
+    timer.hasRun = false;
+
+    if (timer.isRunning)
+    {
+        this->siftUp(timer.heapIndex);
+        this->siftDown(timer.heapIndex);
+        return;
+    }
+
+    this->push(slot);
+}
+
+void MokoshScheduler::stop(size_t slot)
+{
+    if (this->timers[slot].isRunning)
+        this->remove(slot);
+}
+
+void MokoshScheduler::release(size_t slot)
+{
+    Timer &timer = this->timers[slot];
+    this->stop(slot);
+
+    // the function cannot be destroyed while it is running, so the slot is
+    // released after it returns
+    if (slot == this->currentSlot)
+    {
+        this->isCurrentCancelled = true;
+        return;
+    }
+
+    timer.func = nullptr;
+    timer.isUsed = false;
+    timer.generation++;
+
+    this->freeSlots.push_back(slot);
+}
+
+void MokoshScheduler::swap(size_t i, size_t j)
+{
+    size_t slot = this->heap[i];
+    this->heap[i] = this->heap[j];
+    this->heap[j] = slot;
+
+    this->timers[this->heap[i]].heapIndex = i;
+    this->timers[this->heap[j]].heapIndex = j;
+}
+
+void MokoshScheduler::siftUp(size_t i)
+{
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (!this->isEarlier(i, parent))
+            break;
+
+        this->swap(i, parent);
+        i = parent;
+    }
+}
+
+void MokoshScheduler::siftDown(size_t i)
+{
+    size_t size = this->heap.size();
+    for (;;)
+    {
+        size_t earliest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < size && this->isEarlier(left, earliest))
+            earliest = left;
+        if (right < size && this->isEarlier(right, earliest))
+            earliest = right;
+
+        if (earliest == i)
+            break;
+
+        this->swap(i, earliest);
+        i = earliest;
+    }
+}
+
+void MokoshScheduler::push(size_t slot)
+{
+    Timer &timer = this->timers[slot];
+    timer.isRunning = true;
+    timer.heapIndex = this->heap.size();
+
+    this->heap.push_back(slot);
+    this->siftUp(timer.heapIndex);
+}
+
+void MokoshScheduler::remove(size_t slot)
+{
+    Timer &timer = this->timers[slot];
+    size_t i = timer.heapIndex;
+    size_t last = this->heap.size() - 1;
+
+    timer.isRunning = false;
+
+    if (i != last)
+    {
+        size_t moved = this->heap[last];
+        this->swap(i, last);
+        this->heap.pop_back();
+
+        // the last timer moved in its place may belong higher or lower
+        this->siftUp(i);
+        this->siftDown(this->timers[moved].heapIndex);
+    }
+    else
+    {
+        this->heap.pop_back();
+    }
+}
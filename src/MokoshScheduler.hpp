@@ -0,0 +1,310 @@
+#ifndef MOKOSHSCHEDULER_H
+#define MOKOSHSCHEDULER_H
+
+#include <Arduino.h>
+#include <deque>
+#include <limits.h>
+#include <functional>
+#include <vector>
+
+#include "MokoshExecutionStats.hpp"
+
+// function run by the timers, the same as in TickTwo library used before
+typedef std::function<void(void)> fptr;
+
+// if enabled, lateness and jitter of every timer are collected
+#if !defined(MOKOSH_TIMER_STATS)
+#define MOKOSH_TIMER_STATS 1
+#endif
+
+// number of buckets of the histograms, the first one is for 0 ms, then every
+// next is twice as wide (1, 2-3, 4-7 ms etc.), the last one takes the rest
+#if !defined(MOKOSH_TIMER_HISTOGRAM_SIZE)
+#define MOKOSH_TIMER_HISTOGRAM_SIZE 10
+#endif
+
+// what to do when the timer is due for more than one period, e.g. after
+// loop() was blocked for a long time
+typedef enum TimerCatchUpPolicy
+{
+    // the missed runs are dropped, the function waits for the next period
+    SKIP_MISSED = 0,
+
+    // the function runs once, the missed runs are dropped
+    RUN_MISSED_ONCE = 1,
+
+    // the function runs for every missed period, one run per millisecond
+    // until it catches up, so the other timers are not starved
+    RUN_ALL_MISSED = 2
+} TimerCatchUpPolicy;
+
+#if MOKOSH_TIMER_STATS
+// statistics of the timer runs, all times in milliseconds
+struct MokoshTimerStats
+{
+    // number of runs and of runs dropped by the catch-up policy
+    uint32_t runCount;
+    uint32_t missedCount;
+
+    // the largest delay of a run after its deadline
+    unsigned long maxLateness;
+
+    // histograms of delays after the deadlines, and of differences between
+    // the actual time since the previous run and the period
+    uint32_t lateness[MOKOSH_TIMER_HISTOGRAM_SIZE];
+    uint32_t jitter[MOKOSH_TIMER_HISTOGRAM_SIZE];
+};
+#endif
+
+class MokoshScheduler;
+class MokoshTimer;
+
+// function run when a timer function has exceeded its budget, with its
+// duration in microseconds
+typedef std::function<void(MokoshTimer &timer, unsigned long duration)> THandlerFunction_Overrun;
+
+// a lightweight handle of a timer registered in the scheduler, it can be
+// copied freely; after the timer has finished or was cancelled, the handle
+// does nothing, even if the slot was reused by another timer
+class MokoshTimer
+{
+public:
+    MokoshTimer()
+    {
+    }
+
+    MokoshTimer(MokoshScheduler *scheduler, size_t slot, uint32_t generation)
+        : scheduler(scheduler), slot(slot), generation(generation)
+    {
+    }
+
+    // removes the timer, it will not run anymore
+    void cancel();
+
+    // stops the timer, remembering the time left to the next run
+    void pause();
+
+    // starts the paused timer again, with the time left when it was paused
+    void resume();
+
+    // starts (or restarts) the timer, the next run is after the full period
+    void restart();
+
+    // changes the period, the next run is after the new period from now
+    void setPeriod(unsigned long period);
+
+    // returns the period, or 0 if the timer is not active
+    unsigned long getPeriod();
+
+    // sets what to do with the runs missed because the loop was blocked,
+    // by default the function runs once
+    void setCatchUpPolicy(TimerCatchUpPolicy policy);
+
+#if MOKOSH_TIMER_STATS
+    // returns the statistics of the timer, or null if it is not active
+    const MokoshTimerStats *getStats();
+
+    // clears the statistics of the timer
+    void resetStats();
+#endif
+
+    // sets the longest expected execution time of the function in
+    // microseconds, longer runs are counted as overruns; if isDemotable,
+    // after MOKOSH_OVERRUN_DEMOTE_LIMIT overruns in a row the timer runs
+    // twice as rarely (up to 8 times), and returns to its period one step
+    // for every run within the budget
+    void setBudget(unsigned long budget, bool isDemotable = false);
+
+    // returns the execution time statistics of the function, or null if
+    // the timer is not active
+    const MokoshExecutionStats *getExecutionStats();
+
+    // clears the execution time statistics of the function
+    void resetExecutionStats();
+
+    // returns how many times the period is doubled because of overruns
+    int getDemotion();
+
+    // returns the number of the slot, identifying the active timer
+    size_t getId()
+    {
+        return this->slot;
+    }
+
+    // returns if the timer is registered, it was not cancelled and has not
+    // finished all its runs
+    bool isActive();
+
+    // returns if the timer is active and not paused
+    bool isRunning();
+
+private:
+    MokoshScheduler *scheduler = nullptr;
+    size_t slot = 0;
+    uint32_t generation = 0;
+};
+
+// timers running functions on a given interval or after a timeout, kept in
+// a min-heap ordered by the next deadline, so checking if anything is due
+// costs only one comparison
+//
+// the timers run at a fixed rate: the next deadline is the previous one plus
+// the period, not the time of the run plus the period, so they do not drift
+//
+// deadlines are compared relative to each other, so millis() overflow is
+// handled correctly, as long as the intervals are shorter than ~24 days
+//
+// slots of finished and cancelled timers are reused by the new ones
+class MokoshScheduler
+{
+public:
+    // adds a timer running func every interval milliseconds, runs times
+    // (0 means infinitely), the timer is removed after its last run
+    MokoshTimer add(fptr func, unsigned long interval, int runs = 0, bool start = true);
+
+    // starts (or restarts) all the active timers
+    void startAll();
+
+    // runs the functions of all the timers which are due, returns number
+    // of functions run
+    int update();
+
+    // returns time in milliseconds to the earliest deadline, 0 if a timer is
+    // already due, or ULONG_MAX if no timer is running
+    unsigned long getTimeToNext();
+
+    // returns number of active timers
+    size_t getCount()
+    {
+        return this->timers.size() - this->freeSlots.size();
+    }
+
+    // returns number of running timers
+    size_t getRunningCount()
+    {
+        return this->heap.size();
+    }
+
+    // returns number of slots allocated for the timers, active or free
+    size_t getCapacity()
+    {
+        return this->timers.size();
+    }
+
+    // run when a timer function has exceeded its budget
+    THandlerFunction_Overrun onOverrun;
+
+    // returns a handle of the timer in a given slot, it is not active if
+    // the slot is free
+    MokoshTimer getTimer(size_t slot)
+    {
+        if (slot >= this->timers.size())
+            return MokoshTimer();
+
+        return MokoshTimer(this, slot, this->timers[slot].generation);
+    }
+
+private:
+    friend class MokoshTimer;
+
+    static const size_t NONE = (size_t)-1;
+
+    // the period of a demoted timer is multiplied at most by 2^MAX_DEMOTION
+    static const uint8_t MAX_DEMOTION = 3;
+
+    struct Timer
+    {
+        fptr func;
+        unsigned long interval;
+
+        // the time the next run is scheduled for, in phase with the start
+        unsigned long scheduled;
+
+        // the time the timer is due, the same as scheduled, unless it is
+        // catching up with the missed runs
+        unsigned long deadline;
+        unsigned long remaining;
+        unsigned long lastRunTime;
+        int runs;
+        int runCount;
+        uint32_t generation;
+        TimerCatchUpPolicy policy;
+        MokoshExecutionStats execution;
+        uint8_t demotion;
+        bool isDemotable;
+        bool isUsed;
+        bool isRunning;
+        bool hasRun;
+        size_t heapIndex;
+#if MOKOSH_TIMER_STATS
+        MokoshTimerStats stats;
+#endif
+    };
+
+    // deque, so the timers are not moved when a new one is added by a
+    // function being run
+    std::deque<Timer> timers;
+
+    // slots of the finished and cancelled timers, to be reused
+    std::vector<size_t> freeSlots;
+
+    // ids of the running timers, the earliest deadline first
+    std::vector<size_t> heap;
+
+    // the timer which function is being run, and if it was cancelled by it
+    size_t currentSlot = NONE;
+    bool isCurrentCancelled = false;
+
+    // compares times in a way resistant to millis() overflow
+    static bool isBefore(unsigned long a, unsigned long b)
+    {
+        return (long)(a - b) < 0;
+    }
+
+    bool isEarlier(size_t i, size_t j)
+    {
+        return MokoshScheduler::isBefore(this->timers[this->heap[i]].deadline, this->timers[this->heap[j]].deadline);
+    }
+
+    // the period, longer if the timer is demoted
+    static unsigned long getPeriod(const Timer &timer)
+    {
+        return timer.interval << timer.demotion;
+    }
+
+    bool isValid(size_t slot, uint32_t generation)
+    {
+        return slot < this->timers.size() && this->timers[slot].isUsed && this->timers[slot].generation == generation;
+    }
+
+#if MOKOSH_TIMER_STATS
+    // returns the histogram bucket for a given time
+    static size_t getBucket(unsigned long time)
+    {
+        size_t bucket = 0;
+        while (time > 0 && bucket < MOKOSH_TIMER_HISTOGRAM_SIZE - 1)
+        {
+            time >>= 1;
+            bucket++;
+        }
+
+        return bucket;
+    }
+
+    void recordRun(Timer &timer, unsigned long now, unsigned long lateness);
+#endif
+
+    void recordExecution(size_t slot, unsigned long duration);
+
+    void start(size_t slot, unsigned long delay);
+    void stop(size_t slot);
+    void release(size_t slot);
+
+    void swap(size_t i, size_t j);
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    void push(size_t slot);
+    void remove(size_t slot);
+};
+
+#endif
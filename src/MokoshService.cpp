@@ -1,4 +1,5 @@
 #include "MokoshService.hpp"
 
 const char *MokoshService::DEPENDENCY_NETWORK = "NET";
-const char *MokoshService::DEPENDENCY_MQTT = "MQTT";
\ No newline at end of file
+const char *MokoshService::DEPENDENCY_MQTT = "MQTT";
+const unsigned long MokoshService::POLL_NEVER;
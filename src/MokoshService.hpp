@@ -2,9 +2,13 @@
 #define MOKOSHSERVICE_H
 
 #include <Arduino.h>
+#include <limits.h>
 #include <memory>
 #include <vector>
 
+#include "MokoshCommandRegistry.hpp"
+#include "MokoshExecutionStats.hpp"
+
 #if defined(ESP8266)
 #include <Client.h>
 #endif
@@ -27,6 +31,29 @@ typedef std::function<void(String, uint8_t *msg, unsigned int length)> THandlerF
 typedef void (*THandlerFunction_Message)(String, uint8_t *, unsigned int);
 #endif
 
+// the lifecycle of a service, driven by Mokosh::loop()
+typedef enum ServiceState
+{
+    // waiting for the dependencies to get ready
+    SERVICE_REGISTERED = 0,
+    // being set up, setupAsync() has returned SETUP_PENDING
+    SERVICE_STARTING = 1,
+    // set up, looped
+    SERVICE_READY = 2,
+    // cannot be set up, will not be retried
+    SERVICE_FAILED = 3,
+    // setting up has failed, will be retried later
+    SERVICE_BACKOFF = 4
+} ServiceState;
+
+// the result of setupAsync()
+typedef enum SetupResult
+{
+    SETUP_FAILED = 0,
+    SETUP_DONE = 1,
+    SETUP_PENDING = 2
+} SetupResult;
+
 // a class representing a Mokosh Service, a class which is started
 // with dependency on another classes and is being looped along with others
 class MokoshService
@@ -40,12 +67,46 @@ public:
     // is passed to check some data or read configuration
     virtual bool setup() = 0;
 
+    // sets up the service without blocking: called from loop() again as
+    // long as it returns SETUP_PENDING, and again after a backoff if it
+    // returns SETUP_FAILED; by default runs setup()
+    virtual SetupResult setupAsync()
+    {
+        return this->setup() ? SETUP_DONE : SETUP_FAILED;
+    }
+
     // returns if the class has been set up properly
     virtual bool isSetup()
     {
         return this->setupFinished;
     }
 
+    // returns the lifecycle state of the service
+    ServiceState getState()
+    {
+        return this->state;
+    }
+
+    // returns how many times setting up the service was started
+    uint16_t getSetupAttempts()
+    {
+        return this->setupAttempts;
+    }
+
+    // returns time (in milliseconds since begin()) when setting up the
+    // service was started for the first time
+    unsigned long getStartTime()
+    {
+        return this->startTime;
+    }
+
+    // returns time (in milliseconds since begin()) when the service got
+    // ready
+    unsigned long getReadyTime()
+    {
+        return this->readyTime;
+    }
+
     // returns a list of other services this service is dependent on
     // may include some built-in like NET or MQTT which have consts
     // below
@@ -54,7 +115,16 @@ public:
         return {};
     }
 
-    // handles a command
+    // registers the commands handled by the service, called when it is
+    // registered; the service should pass itself as the owner, so they are
+    // removed when it is replaced
+    virtual void registerCommands(MokoshCommandRegistry &commands)
+    {
+    }
+
+    // handles a command which is not registered, returns if it did; the
+    // registered commands are preferred, as they are found without asking
+    // every service
     virtual bool command(String command, String param)
     {
         return false;
@@ -63,12 +133,52 @@ public:
     // loop, run internally by Mokosh:loop()
     virtual void loop() = 0;
 
+    // returns if loop() may be run by the executor, in another thread than
+    // the other services, when it is enabled; the service must not touch
+    // anything not thread-safe then, only the config, logs, MQTT publishing
+    // and Mokosh::post() are
+    virtual bool isRunOnExecutor()
+    {
+        return false;
+    }
+
+    // returns for how long (in milliseconds) Mokosh may sleep without running
+    // loop() of this service, when the idle mode is enabled
+    virtual unsigned long getMaxIdleTime()
+    {
+        return ULONG_MAX;
+    }
+
+    // returns how often (in milliseconds) loop() is run by Mokosh: 0 is in
+    // every iteration, POLL_NEVER is never, for the services doing all the
+    // work in callbacks; it is checked once, when the service gets ready
+    virtual unsigned long getPollInterval()
+    {
+        return 0;
+    }
+
+    // loop() of the service does not need to be run at all
+    static const unsigned long POLL_NEVER = ULONG_MAX;
+
     // returns default name for keyed registration of the service
     virtual const char *key()
     {
         return "";
     }
 
+    // sets the longest expected execution time of loop() in microseconds,
+    // longer runs are counted and logged as overruns, 0 disables it
+    void setBudget(unsigned long budget)
+    {
+        this->execution.budget = budget;
+    }
+
+    // returns the execution time statistics of loop(), measured by Mokosh
+    MokoshExecutionStats &getExecutionStats()
+    {
+        return this->execution;
+    }
+
     // some built-in names for dependencies
 
     // marks this service is dependent on the network connection
@@ -79,6 +189,28 @@ public:
 
 protected:
     bool setupFinished = false;
+
+private:
+    MokoshExecutionStats execution;
+
+    // run by MokoshStatic, so it is not polled by Mokosh
+    bool isStatic = false;
+
+    // the profiler slot of loop(), found when the service is polled for the
+    // first time
+    bool isProfileSlotFound = false;
+    int profileSlot = -1;
+
+    ServiceState state = SERVICE_REGISTERED;
+    uint16_t setupAttempts = 0;
+    unsigned long startTime = 0;
+    unsigned long readyTime = 0;
+
+    // when the backoff ends
+    unsigned long retryTime = 0;
+
+    // drives the lifecycle
+    friend class Mokosh;
 };
 
 class MokoshNetworkService : public MokoshService
@@ -0,0 +1,113 @@
+#include "MokoshServiceRegistry.hpp"
+#include "MokoshHash.hpp"
+
+const char *MokoshServiceRegistry::add(const char *key, std::shared_ptr<MokoshService> service)
+{
+    int i = this->indexOf(key);
+    if (i != -1)
+    {
+        this->entries[i].second = service;
+        this->dependencies[i] = service->getDependencies();
+        return this->entries[i].first;
+    }
+
+    size_t length = strlen(key);
+    char *interned = new char[length + 1];
+    memcpy(interned, key, length + 1);
+
+    this->keys.push_back(std::unique_ptr<char[]>(interned));
+    this->hashes.push_back(MokoshHash::hash(interned, length));
+    this->entries.push_back(MokoshServiceEntry(interned, service));
+    this->dependencies.push_back(service->getDependencies());
+
+    this->rebuildIndex();
+    return interned;
+}
+
+int MokoshServiceRegistry::indexOf(const char *key) const
+{
+    if (this->index.empty())
+        return -1;
+
+    uint32_t hash = MokoshHash::hash(key);
+    size_t mask = this->index.size() - 1;
+
+    // the table is never full, so there is always an empty place ending
+    // the search
+    for (size_t place = hash & mask; this->index[place] != 0; place = (place + 1) & mask)
+    {
+        int i = this->index[place] - 1;
+        if (this->hashes[i] == hash && strcmp(this->entries[i].first, key) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+void MokoshServiceRegistry::rebuildIndex()
+{
+    size_t capacity = 16;
+    while (capacity < this->entries.size() * 2)
+        capacity *= 2;
+
+    this->index.assign(capacity, 0);
+
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < this->entries.size(); i++)
+    {
+        size_t place = this->hashes[i] & mask;
+        while (this->index[place] != 0)
+            place = (place + 1) & mask;
+
+        this->index[place] = i + 1;
+    }
+}
+
+std::vector<int> MokoshServiceRegistry::sort(std::vector<int> &cyclic) const
+{
+    // Kahn's algorithm: a service is taken when all the services it depends
+    // on are taken
+    size_t count = this->entries.size();
+    std::vector<int> pending(count, 0);
+    std::vector<std::vector<int>> dependents(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        for (auto &key : this->dependencies[i])
+        {
+            int dependency = this->indexOf(key);
+            if (dependency == -1)
+                continue;
+
+            pending[i]++;
+            dependents[dependency].push_back(i);
+        }
+    }
+
+    std::vector<int> order;
+    order.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pending[i] == 0)
+            order.push_back(i);
+    }
+
+    // the order is extended while it is being walked
+    for (size_t next = 0; next < order.size(); next++)
+    {
+        for (int dependent : dependents[order[next]])
+        {
+            if (--pending[dependent] == 0)
+                order.push_back(dependent);
+        }
+    }
+
+    cyclic.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (pending[i] > 0)
+            cyclic.push_back(i);
+    }
+
+    return order;
+}
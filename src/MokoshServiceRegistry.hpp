@@ -0,0 +1,99 @@
+#ifndef MOKOSHSERVICEREGISTRY_H
+#define MOKOSHSERVICEREGISTRY_H
+
+#include <Arduino.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "MokoshService.hpp"
+
+// a service with the key it is registered under
+typedef std::pair<const char *, std::shared_ptr<MokoshService>> MokoshServiceEntry;
+
+// the services registered by keys, iterated in the order of registration
+//
+// the keys are copied (interned) on registration, so they are compared by
+// content and the caller does not need to keep them, and are found by hash
+// in O(1); the dependencies of the services are queried once, on
+// registration
+class MokoshServiceRegistry
+{
+public:
+    typedef std::vector<MokoshServiceEntry>::const_iterator const_iterator;
+
+    // registers a service under a key, replacing the one already registered
+    // under it, returns the interned key
+    const char *add(const char *key, std::shared_ptr<MokoshService> service);
+
+    // returns position of the service registered under a key, or -1
+    int indexOf(const char *key) const;
+
+    // returns if there is a service registered under a key
+    bool contains(const char *key) const
+    {
+        return this->indexOf(key) != -1;
+    }
+
+    // returns the service registered under a key, or null
+    std::shared_ptr<MokoshService> get(const char *key) const
+    {
+        int i = this->indexOf(key);
+        return i != -1 ? this->entries[i].second : nullptr;
+    }
+
+    // returns the entry at a given position
+    const MokoshServiceEntry &at(int i) const
+    {
+        return this->entries[i];
+    }
+
+    // returns keys of the services the service at a given position depends
+    // on, as returned by its getDependencies() on registration
+    const std::vector<const char *> &getDependencies(int i) const
+    {
+        return this->dependencies[i];
+    }
+
+    // returns positions of the services ordered so every one is after the
+    // ones it depends on, independent ones in the order of registration;
+    // the services in dependency cycles are left out and put in cyclic;
+    // dependencies which are not registered are ignored
+    std::vector<int> sort(std::vector<int> &cyclic) const;
+
+    size_t size() const
+    {
+        return this->entries.size();
+    }
+
+    const_iterator begin() const
+    {
+        return this->entries.begin();
+    }
+
+    const_iterator end() const
+    {
+        return this->entries.end();
+    }
+
+private:
+    std::vector<MokoshServiceEntry> entries;
+
+    // hashes of the keys of the entries
+    std::vector<uint32_t> hashes;
+
+    // dependencies of the entries
+    std::vector<std::vector<const char *>> dependencies;
+
+    // the interned keys, owned by the registry
+    std::vector<std::unique_ptr<char[]>> keys;
+
+    // open addressing table with positions of the entries plus one, 0 for
+    // empty places, at least twice as large as the number of entries
+    std::vector<uint16_t> index;
+
+    // recreates the table for the current number of entries
+    void rebuildIndex();
+};
+
+#endif
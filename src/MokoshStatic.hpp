@@ -0,0 +1,182 @@
+#ifndef MOKOSHSTATIC_H
+#define MOKOSHSTATIC_H
+
+#include <Mokosh.hpp>
+#include <tuple>
+#include <utility>
+
+#if __cplusplus >= 201703L
+
+// the key and the dependencies of a service type known during compilation,
+// taken from its STATIC_KEY and STATIC_DEPENDENCIES (keys ended with
+// nullptr), or given by specializing this template for the type
+template <typename T>
+struct MokoshStaticTraits
+{
+    static constexpr const char *key = T::STATIC_KEY;
+    static constexpr const char *const *dependencies = T::STATIC_DEPENDENCIES;
+};
+
+namespace MokoshStaticChecks
+{
+    constexpr bool equals(const char *a, const char *b)
+    {
+        while (*a != 0 && *a == *b)
+        {
+            a++;
+            b++;
+        }
+
+        return *a == *b;
+    }
+
+    // returns if every dependency of every service is provided by a service
+    // before it, so the services are set up in the given order
+    template <typename... Services>
+    constexpr bool areDependenciesOrdered()
+    {
+        const char *keys[] = {MokoshStaticTraits<Services>::key...};
+        const char *const *dependencies[] = {MokoshStaticTraits<Services>::dependencies...};
+
+        for (size_t i = 0; i < sizeof...(Services); i++)
+        {
+            for (size_t d = 0; dependencies[i][d] != nullptr; d++)
+            {
+                bool isProvided = false;
+                for (size_t j = 0; j < i; j++)
+                    isProvided = isProvided || equals(keys[j], dependencies[i][d]);
+
+                if (!isProvided)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // returns if no two services have the same key
+    template <typename... Services>
+    constexpr bool areKeysUnique()
+    {
+        const char *keys[] = {MokoshStaticTraits<Services>::key...};
+
+        for (size_t i = 0; i < sizeof...(Services); i++)
+        {
+            for (size_t j = 0; j < i; j++)
+            {
+                if (equals(keys[i], keys[j]))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    // returns if any service has a given key
+    template <typename... Services>
+    constexpr bool provides(const char *key)
+    {
+        return (equals(MokoshStaticTraits<Services>::key, key) || ...);
+    }
+}
+
+// the services of MokoshStatic, a base class listed before Mokosh, so they
+// are constructed before it and destroyed after it, while the registry and
+// the commands of Mokosh still point to them
+template <typename... Services>
+class MokoshStaticServices
+{
+protected:
+    std::tuple<Services...> composedServices;
+};
+
+// Mokosh with the services composed during compilation, e.g.
+// MokoshStatic<MokoshWiFiService, PubSubClientService, MyService>
+//
+// the services are members of the object, not allocated, and their keys
+// and dependencies are checked during compilation - every service has to
+// be after the ones it depends on; they are registered, so they are set up,
+// listed and found as the others, but their loop() is called directly, with
+// the type known, so without virtual dispatch
+//
+// it is still a Mokosh, with its registry, commands and vtables, which the
+// built-in services need, so it is not smaller or faster than Mokosh, it
+// only moves the errors of composing the services to the compilation
+template <typename... Services>
+class MokoshStatic : private MokoshStaticServices<Services...>, public Mokosh
+{
+    static_assert(sizeof...(Services) > 0, "MokoshStatic needs at least one service");
+    static_assert(MokoshStaticChecks::areKeysUnique<Services...>(), "services of MokoshStatic must have different keys");
+    static_assert(MokoshStaticChecks::areDependenciesOrdered<Services...>(), "every service of MokoshStatic must be after the services it depends on");
+
+public:
+    MokoshStatic(String prefix, String version = "1.0.0", bool useFilesystem = true, bool useSerial = true)
+        : Mokosh(prefix, version, useFilesystem, useSerial)
+    {
+        (this->registerStaticService(MokoshStaticTraits<Services>::key, &std::get<Services>(this->composedServices)), ...);
+        this->staticServicesLoop = &MokoshStatic::loopServices;
+
+        // hello is sent as with the default network and MQTT
+        if (MokoshStaticChecks::provides<Services...>(MokoshService::DEPENDENCY_MQTT))
+            this->helloDependency = MokoshService::DEPENDENCY_MQTT;
+        else if (MokoshStaticChecks::provides<Services...>(MokoshService::DEPENDENCY_NETWORK))
+            this->helloDependency = MokoshService::DEPENDENCY_NETWORK;
+    }
+
+    // returns the service of a given type, e.g. to configure it before begin()
+    template <typename T>
+    T &get()
+    {
+        return std::get<T>(this->composedServices);
+    }
+
+private:
+    // the next run time of the periodic services, in milliseconds
+    unsigned long dueTimes[sizeof...(Services)] = {0};
+
+    static unsigned long loopServices(Mokosh *mokosh, unsigned long time)
+    {
+        auto self = static_cast<MokoshStatic *>(mokosh);
+        return self->loopAll(time, std::index_sequence_for<Services...>());
+    }
+
+    template <size_t... I>
+    unsigned long loopAll(unsigned long time, std::index_sequence<I...>)
+    {
+        ((time = this->loopOne<I>(time)), ...);
+        return time;
+    }
+
+    template <size_t I>
+    unsigned long loopOne(unsigned long time)
+    {
+        typedef typename std::tuple_element<I, std::tuple<Services...>>::type T;
+        T &service = std::get<I>(this->composedServices);
+
+        // services are not run until they are set up
+        if (service.getState() != SERVICE_READY)
+            return time;
+
+        unsigned long interval = service.T::getPollInterval();
+        if (interval == MokoshService::POLL_NEVER)
+            return time;
+
+        if (interval > 0)
+        {
+            unsigned long now = millis();
+            if ((long)(now - this->dueTimes[I]) < 0)
+                return time;
+
+            this->dueTimes[I] = now + interval;
+        }
+
+        // the key is a literal, so the slot is looked up only once
+        MOKOSH_PROFILE_SCOPE(MokoshStaticTraits<T>::key);
+        service.T::loop();
+        return this->recordService(MokoshStaticTraits<T>::key, &service, time);
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef MOKOSHSTRINGVIEW_H
+#define MOKOSHSTRINGVIEW_H
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+// a non-owning view of a part of a string, which does not have to be
+// null-terminated, so a received buffer can be parsed without copying it
+// or allocating; it is valid only as long as the viewed string
+struct MokoshStringView
+{
+    const char *data = "";
+    size_t length = 0;
+
+    MokoshStringView()
+    {
+    }
+
+    MokoshStringView(const char *data, size_t length) : data(data), length(length)
+    {
+    }
+
+    explicit MokoshStringView(const char *str) : data(str), length(strlen(str))
+    {
+    }
+
+    bool isEmpty() const
+    {
+        return this->length == 0;
+    }
+
+    // returns if the view has the same content as a null-terminated string;
+    // the lengths are compared first, so a shorter string is not read past
+    // its end, even if the view contains a null character
+    bool equals(const char *str) const
+    {
+        return strlen(str) == this->length && memcmp(this->data, str, this->length) == 0;
+    }
+
+    bool operator==(const char *str) const
+    {
+        return this->equals(str);
+    }
+
+    bool operator!=(const char *str) const
+    {
+        return !this->equals(str);
+    }
+
+    // returns position of the first occurrence of a character, or -1
+    int indexOf(char c, size_t from = 0) const
+    {
+        if (from >= this->length)
+            return -1;
+
+        const char *found = (const char *)memchr(this->data + from, c, this->length - from);
+        return found != nullptr ? (int)(found - this->data) : -1;
+    }
+
+    // returns a view of the part from one position to another (exclusive),
+    // clamped to the viewed string
+    MokoshStringView substring(size_t from, size_t to = (size_t)-1) const
+    {
+        if (to > this->length)
+            to = this->length;
+
+        if (from > to)
+            from = to;
+
+        return MokoshStringView(this->data + from, to - from);
+    }
+
+    // copies the content to a buffer as a null-terminated string, cut to its
+    // size, returns the copied length
+    size_t copyTo(char *buffer, size_t size) const
+    {
+        if (size == 0)
+            return 0;
+
+        size_t length = this->length < size - 1 ? this->length : size - 1;
+        memcpy(buffer, this->data, length);
+        buffer[length] = 0;
+
+        return length;
+    }
+
+    // parses the content as an integer, 0 if it is not a number
+    long toInt() const
+    {
+        char buffer[24];
+        this->copyTo(buffer, sizeof(buffer));
+        return strtol(buffer, nullptr, 10);
+    }
+
+    // parses the content as a float, 0 if it is not a number
+    float toFloat() const
+    {
+        char buffer[32];
+        this->copyTo(buffer, sizeof(buffer));
+        return strtof(buffer, nullptr);
+    }
+
+    // returns a copy of the content, allocated on the heap
+    String toString() const
+    {
+        String result;
+        result.reserve(this->length);
+        for (size_t i = 0; i < this->length; i++)
+            result += this->data[i];
+
+        return result;
+    }
+};
+
+#endif
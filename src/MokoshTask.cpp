@@ -0,0 +1,145 @@
+#include "MokoshTask.hpp"
+
+bool MokoshTask::step()
+{
+    if (this->isDone)
+        return false;
+
+    if (this->isSleeping)
+    {
+        if ((long)(millis() - this->wakeTime) < 0)
+            return true;
+
+        this->isSleeping = false;
+    }
+
+    if (!this->run())
+        this->isDone = true;
+
+    return !this->isDone;
+}
+
+unsigned long MokoshTask::getTimeToNext()
+{
+    if (this->isDone)
+        return ULONG_MAX;
+
+    if (this->isSleeping)
+    {
+        long time = (long)(this->wakeTime - millis());
+        return time > 0 ? time : 0;
+    }
+
+    // the condition can change anytime, so it is checked periodically
+    if (this->isWaiting)
+    {
+        unsigned long time = MOKOSH_TASK_POLL_TIME;
+        if (this->hasDeadline)
+        {
+            long remaining = (long)(this->waitDeadline - millis());
+            time = std::min(time, (unsigned long)(remaining > 0 ? remaining : 0));
+        }
+
+        return time;
+    }
+
+    return 0;
+}
+
+void MokoshTask::join()
+{
+    while (this->step())
+        delay(this->getTimeToNext());
+}
+
+void MokoshTask::startSleep(unsigned long time)
+{
+    this->wakeTime = millis() + time;
+    this->isSleeping = true;
+}
+
+void MokoshTask::startWaiting(unsigned long timeout)
+{
+    this->isWaiting = true;
+    this->hasTimedOut = false;
+    this->hasDeadline = timeout != ULONG_MAX;
+    this->waitDeadline = millis() + timeout;
+}
+
+bool MokoshTask::checkWait(bool isConditionMet)
+{
+    if (!isConditionMet)
+    {
+        if (!this->hasDeadline || (long)(millis() - this->waitDeadline) < 0)
+            return false;
+
+        this->hasTimedOut = true;
+    }
+
+    this->isWaiting = false;
+    return true;
+}
+
+#if MOKOSH_COROUTINES
+bool MokoshCoroutine::run()
+{
+    if (!this->handle || this->handle.done())
+        return false;
+
+    promise_type &promise = this->handle.promise();
+    if (promise.condition != nullptr)
+    {
+        if (!this->checkWait(promise.condition()))
+            return true;
+
+        promise.isTimedOut = this->isTimedOut();
+        promise.condition = nullptr;
+    }
+
+    this->handle.resume();
+    if (this->handle.done())
+        return false;
+
+    // the awaiters only store what the coroutine waits for
+    if (promise.isSleepRequested)
+    {
+        promise.isSleepRequested = false;
+        this->startSleep(promise.sleepTime);
+    }
+    else if (promise.condition != nullptr)
+    {
+        this->startWaiting(promise.timeout);
+    }
+
+    return true;
+}
+#endif
+
+size_t MokoshTaskRunner::update()
+{
+    // a task may add new ones, so they are accessed by index, and the added
+    // ones wait for the next update
+    size_t count = this->tasks.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        std::shared_ptr<MokoshTask> task = this->tasks[i];
+        task->step();
+    }
+
+    this->tasks.erase(std::remove_if(this->tasks.begin(), this->tasks.end(), [](const std::shared_ptr<MokoshTask> &task)
+                                     { return task->isFinished(); }),
+                      this->tasks.end());
+
+    return this->tasks.size();
+}
+
+unsigned long MokoshTaskRunner::getTimeToNext()
+{
+    unsigned long time = ULONG_MAX;
+    for (auto &task : this->tasks)
+    {
+        time = std::min(time, task->getTimeToNext());
+    }
+
+    return time;
+}
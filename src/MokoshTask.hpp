@@ -0,0 +1,326 @@
+#ifndef MOKOSHTASK_H
+#define MOKOSHTASK_H
+
+#include <Arduino.h>
+#include <algorithm>
+#include <functional>
+#include <limits.h>
+#include <memory>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#define MOKOSH_COROUTINES 1
+#else
+#define MOKOSH_COROUTINES 0
+#endif
+
+// how often (in milliseconds) the conditions of the waiting tasks are
+// checked at least, when the idle mode is enabled
+#if !defined(MOKOSH_TASK_POLL_TIME)
+#define MOKOSH_TASK_POLL_TIME 10
+#endif
+
+// a cooperative task run by Mokosh::loop(), which instead of blocking
+// returns to the loop and is continued later, from the place it stopped
+//
+// the body is written in run() between MOKOSH_TASK_BEGIN() and
+// MOKOSH_TASK_END() macros, it is stackless: local variables are lost when
+// the task waits, so the state must be kept in the members, and two waits
+// cannot be placed in the same line
+class MokoshTask
+{
+public:
+    virtual ~MokoshTask()
+    {
+    }
+
+    // runs the task until it waits or finishes, returns false if it has
+    // finished
+    bool step();
+
+    // stops the task, it will not be run anymore
+    void cancel()
+    {
+        this->isDone = true;
+    }
+
+    // returns if the task has finished or was cancelled
+    bool isFinished()
+    {
+        return this->isDone;
+    }
+
+    // returns time in milliseconds after which the task should be run again
+    unsigned long getTimeToNext();
+
+    // runs the task until it finishes, blocking; to be used only where
+    // blocking is acceptable, e.g. in begin() before the loop starts
+    void join();
+
+protected:
+    // the body of the task, returns false when it has finished
+    virtual bool run() = 0;
+
+    // makes the task not run for a given time
+    void startSleep(unsigned long time);
+
+    // makes the task wait for a condition, but no longer than timeout
+    void startWaiting(unsigned long timeout = ULONG_MAX);
+
+    // returns if the wait is over, because the condition is met or time is
+    // out
+    bool checkWait(bool isConditionMet);
+
+    // returns if the last wait has ended because of the timeout
+    bool isTimedOut()
+    {
+        return this->hasTimedOut;
+    }
+
+    // the place in the body where the task is continued, used by the macros
+    int taskLine = 0;
+
+private:
+    unsigned long wakeTime = 0;
+    unsigned long waitDeadline = 0;
+    bool isSleeping = false;
+    bool isWaiting = false;
+    bool hasDeadline = false;
+    bool hasTimedOut = false;
+    bool isDone = false;
+};
+
+// starts the body of a task
+#define MOKOSH_TASK_BEGIN()  \
+    switch (this->taskLine)  \
+    {                        \
+    case 0:
+
+// ends the body of a task
+#define MOKOSH_TASK_END() \
+    }                     \
+    this->taskLine = 0;   \
+    return false
+
+// finishes the task immediately
+#define MOKOSH_TASK_EXIT()  \
+    do                      \
+    {                       \
+        this->taskLine = 0; \
+        return false;       \
+    } while (0)
+
+// returns to the loop, the task continues in the next iteration
+#define MOKOSH_TASK_YIELD()        \
+    do                             \
+    {                              \
+        this->taskLine = __LINE__; \
+        return true;               \
+    case __LINE__:;                \
+    } while (0)
+
+// returns to the loop, the task continues after time in milliseconds
+#define MOKOSH_TASK_SLEEP(time)    \
+    do                             \
+    {                              \
+        this->startSleep(time);    \
+        this->taskLine = __LINE__; \
+        return true;               \
+    case __LINE__:;                \
+    } while (0)
+
+// returns to the loop until the condition is met
+#define MOKOSH_TASK_UNTIL(condition)            \
+    do                                          \
+    {                                           \
+        this->startWaiting();                   \
+        this->taskLine = __LINE__;              \
+    case __LINE__:                              \
+        if (!this->checkWait((condition)))      \
+            return true;                        \
+    } while (0)
+
+// returns to the loop until the condition is met, but no longer than
+// timeout in milliseconds, isTimedOut() tells which happened
+#define MOKOSH_TASK_UNTIL_TIMEOUT(condition, timeout) \
+    do                                                \
+    {                                                 \
+        this->startWaiting(timeout);                  \
+        this->taskLine = __LINE__;                    \
+    case __LINE__:                                    \
+        if (!this->checkWait((condition)))            \
+            return true;                              \
+    } while (0)
+
+#if MOKOSH_COROUTINES
+// a task written as a C++20 coroutine, where waiting is done with
+// co_await MokoshCoroutine::sleep(time) and co_await MokoshCoroutine::until()
+// e.g.:
+//
+// MokoshCoroutine blink()
+// {
+//     for (;;)
+//     {
+//         digitalWrite(LED, HIGH);
+//         co_await MokoshCoroutine::sleep(100);
+//         digitalWrite(LED, LOW);
+//         co_await MokoshCoroutine::sleep(900);
+//     }
+// }
+//
+// mokosh.startTask(std::make_shared<MokoshCoroutine>(blink()));
+class MokoshCoroutine : public MokoshTask
+{
+public:
+    struct promise_type
+    {
+        // the wait requested by the last co_await
+        unsigned long sleepTime = 0;
+        bool isSleepRequested = false;
+        std::function<bool(void)> condition;
+        unsigned long timeout = ULONG_MAX;
+        bool isTimedOut = false;
+
+        MokoshCoroutine get_return_object()
+        {
+            return MokoshCoroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        // the body starts in the first step(), not on creation
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    struct SleepAwaiter
+    {
+        unsigned long time;
+
+        bool await_ready()
+        {
+            return false;
+        }
+
+        void await_suspend(handle_type handle)
+        {
+            handle.promise().sleepTime = this->time;
+            handle.promise().isSleepRequested = true;
+        }
+
+        void await_resume()
+        {
+        }
+    };
+
+    struct UntilAwaiter
+    {
+        std::function<bool(void)> condition;
+        unsigned long timeout;
+        handle_type handle;
+
+        bool await_ready()
+        {
+            return this->condition();
+        }
+
+        void await_suspend(handle_type handle)
+        {
+            this->handle = handle;
+            handle.promise().condition = this->condition;
+            handle.promise().timeout = this->timeout;
+        }
+
+        // true if the condition is met, false if time is out
+        bool await_resume()
+        {
+            return !this->handle || !this->handle.promise().isTimedOut;
+        }
+    };
+
+    // suspends the coroutine for time in milliseconds
+    static SleepAwaiter sleep(unsigned long time)
+    {
+        return SleepAwaiter{time};
+    }
+
+    // suspends the coroutine until the condition is met, or no longer than
+    // timeout in milliseconds; co_await returns false if time is out
+    static UntilAwaiter until(std::function<bool(void)> condition, unsigned long timeout = ULONG_MAX)
+    {
+        return UntilAwaiter{condition, timeout, nullptr};
+    }
+
+    explicit MokoshCoroutine(handle_type handle) : handle(handle)
+    {
+    }
+
+    MokoshCoroutine(MokoshCoroutine &&other) : handle(other.handle)
+    {
+        other.handle = nullptr;
+    }
+
+    MokoshCoroutine(const MokoshCoroutine &) = delete;
+    MokoshCoroutine &operator=(const MokoshCoroutine &) = delete;
+
+    virtual ~MokoshCoroutine()
+    {
+        if (this->handle)
+            this->handle.destroy();
+    }
+
+protected:
+    virtual bool run() override;
+
+private:
+    handle_type handle;
+};
+#endif
+
+// runs the cooperative tasks from Mokosh::loop(), finished tasks are removed
+class MokoshTaskRunner
+{
+public:
+    // adds a task, it is run for the first time in the next update()
+    void add(std::shared_ptr<MokoshTask> task)
+    {
+        this->tasks.push_back(task);
+    }
+
+    // runs a step of all the tasks which are not sleeping, returns number
+    // of tasks which have not finished yet
+    size_t update();
+
+    // returns time in milliseconds after which any of the tasks should be
+    // run again, or ULONG_MAX if there are no tasks
+    unsigned long getTimeToNext();
+
+    // returns number of tasks which have not finished yet
+    size_t getCount()
+    {
+        return this->tasks.size();
+    }
+
+private:
+    std::vector<std::shared_ptr<MokoshTask>> tasks;
+};
+
+#endif
@@ -26,27 +26,32 @@ public:
 
     virtual bool setup() override
     {
-        auto mokosh = Mokosh::getInstance();
+        this->configure();
 
-        WiFi.enableAP(0);
-        char fullHostName[32] = {0};
-        sprintf(fullHostName, "%s_%s", mokosh->getPrefix().c_str(), mokosh->getHostName().c_str());
-#if defined(ESP8266)
-        WiFi.hostname(fullHostName);
-#endif
+        // the first connection is waited for, so the services dependent on
+        // the network can be set up after it
+        this->reconnect();
+        this->reconnectTask->join();
 
-#if defined(ESP32)
-        // workaround for https://github.com/espressif/arduino-esp32/issues/2537
-        // workaround for https://github.com/espressif/arduino-esp32/issues/4732
-        // workaround for https://github.com/espressif/arduino-esp32/issues/6700#issuecomment-1140331981
-        WiFi.config(((u32_t)0x0UL), ((u32_t)0x0UL), ((u32_t)0x0UL));
-        WiFi.mode(WIFI_MODE_NULL);
-        WiFi.setHostname(fullHostName);
-#endif
+        return this->isConnected();
+    }
 
-        this->setupFinished = true;
+    // starts connecting, and returns SETUP_PENDING until the connecting task
+    // has finished, so begin() does not wait for the network
+    virtual SetupResult setupAsync() override
+    {
+        if (!this->isSetupStarted)
+        {
+            this->configure();
+            this->isSetupStarted = true;
+            this->reconnect();
+        }
+
+        if (this->isReconnecting())
+            return SETUP_PENDING;
 
-        return reconnect();
+        this->isSetupStarted = false;
+        return this->isConnected() ? SETUP_DONE : SETUP_FAILED;
     }
 
     virtual void loop() override
@@ -64,6 +69,16 @@ public:
         }
     }
 
+    // loop() only watches the status for a disconnection
+    virtual unsigned long getPollInterval() override
+    {
+        return 100;
+    }
+
+    // the key and the dependencies for MokoshStatic
+    static constexpr const char *STATIC_KEY = "NET";
+    static constexpr const char *STATIC_DEPENDENCIES[] = {nullptr};
+
     // returns "NETWORK", it's a basic network service, others are dependent
     // on it
     virtual const char *key()
@@ -89,16 +104,114 @@ public:
         return WiFi.localIP().toString();
     }
 
+    // starts connecting to the network, it is done by a task run in the
+    // loop, so it does not block; returns if it is connected already
     bool reconnect()
+    {
+        if (!this->isReconnecting())
+        {
+            this->reconnectTask = std::make_shared<ReconnectTask>(this);
+            Mokosh::getInstance()->startTask(this->reconnectTask);
+        }
+
+        return this->isConnected();
+    }
+
+    // returns if the connecting task is still running
+    bool isReconnecting()
+    {
+        return this->reconnectTask != nullptr && !this->reconnectTask->isFinished();
+    }
+
+private:
+    // how long the connection is waited for, in milliseconds
+    static const unsigned long CONNECTION_TIMEOUT = 10000;
+
+    class ReconnectTask : public MokoshTask
+    {
+    public:
+        ReconnectTask(MokoshWiFiService *service) : service(service)
+        {
+        }
+
+    protected:
+        virtual bool run() override
+        {
+            MOKOSH_TASK_BEGIN();
+
+            if (!this->service->beginConnection())
+                MOKOSH_TASK_EXIT();
+
+            this->startTime = millis();
+            while (WiFi.status() != WL_CONNECTED && millis() - this->startTime < MokoshWiFiService::CONNECTION_TIMEOUT)
+            {
+                Mokosh::debug_ticker_step();
+                MOKOSH_TASK_SLEEP(250);
+            }
+
+            this->service->finishConnection();
+
+            MOKOSH_TASK_END();
+        }
+
+    private:
+        MokoshWiFiService *service;
+        unsigned long startTime = 0;
+    };
+
+    std::shared_ptr<ReconnectTask> reconnectTask;
+
+#if defined(ESP32)
+    std::unique_ptr<WiFiMulti> wifiMulti;
+#endif
+
+    // whether setupAsync() has started connecting
+    bool isSetupStarted = false;
+
+    // prepares Wi-Fi to connect, only once
+    void configure()
+    {
+        if (this->setupFinished)
+            return;
+
+        auto mokosh = Mokosh::getInstance();
+
+        WiFi.enableAP(0);
+        char fullHostName[32] = {0};
+        sprintf(fullHostName, "%s_%s", mokosh->getPrefix().c_str(), mokosh->getHostName().c_str());
+#if defined(ESP8266)
+        WiFi.hostname(fullHostName);
+#endif
+
+#if defined(ESP32)
+        // workaround for https://github.com/espressif/arduino-esp32/issues/2537
+        // workaround for https://github.com/espressif/arduino-esp32/issues/4732
+        // workaround for https://github.com/espressif/arduino-esp32/issues/6700#issuecomment-1140331981
+        WiFi.config(((u32_t)0x0UL), ((u32_t)0x0UL), ((u32_t)0x0UL));
+        WiFi.mode(WIFI_MODE_NULL);
+        WiFi.setHostname(fullHostName);
+
+        // Wi-Fi events interrupt the idle sleep
+        WiFi.onEvent([](arduino_event_id_t event)
+                     { Mokosh::getInstance()->wakeUp(); });
+#endif
+
+        this->setupFinished = true;
+    }
+
+    // starts connecting to the configured network, returns false if the
+    // configuration is wrong
+    bool beginConnection()
     {
         auto config = Mokosh::getInstance()->config;
+        this->previousWifiStatus = this->lastWifiStatus;
 
         bool multi = config->hasKey(config->key_multi_ssid);
 
         if (multi)
         {
 #if defined(ESP32)
-            WiFiMulti wifiMulti;
+            this->wifiMulti.reset(new WiFiMulti());
 
             String multi = config->get<String>(config->key_multi_ssid, "");
             mlogD("Will try multiple SSID");
@@ -118,13 +231,12 @@ public:
                 const char *ssid = item["ssid"];
                 const char *password = item["password"];
 
-                wifiMulti.addAP(ssid, password);
+                this->wifiMulti->addAP(ssid, password);
             }
 
-            if (wifiMulti.run(10000) == WL_CONNECTED)
-            {
-                mlogI("Connected to %s", WiFi.SSID().c_str());
-            }
+            // only starts connecting to the best network, the scan is still
+            // blocking
+            this->wifiMulti->run(0);
 #else
             mlogE("Multiple SSIDs are not supported on ESP8266");
             return false;
@@ -143,22 +255,23 @@ public:
 
             WiFi.begin(ssid.c_str(), password.c_str());
             this->isWiFiConfigured = true;
-
-            unsigned long startTime = millis();
-            while (WiFi.status() != WL_CONNECTED && millis() - startTime < 10000)
-            {
-                Mokosh::debug_ticker_step();
-                delay(250);
-            }
         }
 
+        return true;
+    }
+
+    // runs the handlers after connecting has succeeded or failed
+    void finishConnection()
+    {
+        // loop() could have updated the last status in the meantime, so the
+        // one from before connecting is used
         wl_status_t wifiStatus = WiFi.status();
-        if (wifiStatus != lastWifiStatus && wifiStatus == WL_CONNECTED)
+        if (wifiStatus != this->previousWifiStatus && wifiStatus == WL_CONNECTED)
         {
             if (this->wifiEvents.onConnect != nullptr)
                 this->wifiEvents.onConnect();
         }
-        else if (wifiStatus != lastWifiStatus && wifiStatus == WL_CONNECT_FAILED)
+        else if (wifiStatus != this->previousWifiStatus && wifiStatus == WL_CONNECT_FAILED)
         {
             if (this->wifiEvents.onConnectFail != nullptr)
                 this->wifiEvents.onConnectFail();
@@ -172,18 +285,21 @@ public:
         else
         {
             Mokosh::debug_ticker_finish(false);
-            return false;
+            return;
         }
 
+#if defined(ESP32)
+        if (this->wifiMulti != nullptr)
+            mlogI("Connected to %s", WiFi.SSID().c_str());
+#endif
+
         mlogI("IP: %s", WiFi.localIP().toString().c_str());
         this->client = std::make_shared<WiFiClient>();
-
-        return lastWifiStatus == WL_CONNECTED;
     }
 
-private:
     bool isWiFiConfigured;
-    wl_status_t lastWifiStatus;
+    wl_status_t lastWifiStatus = WL_IDLE_STATUS;
+    wl_status_t previousWifiStatus = WL_IDLE_STATUS;
     std::shared_ptr<WiFiClient> client = nullptr;
 };
 
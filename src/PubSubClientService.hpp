@@ -66,6 +66,13 @@ public:
         this->mqtt->loop();
     }
 
+    // incoming messages are read only in loop(), so it limits how late
+    // the commands are handled
+    virtual unsigned long getMaxIdleTime() override
+    {
+        return 100;
+    }
+
     // returns "MQTT", it's a quite basic network service, others are dependent
     // on it
     virtual const char *key()
@@ -79,9 +86,13 @@ public:
         return {MokoshService::DEPENDENCY_NETWORK};
     }
 
+    // the key and the dependencies for MokoshStatic
+    static constexpr const char *STATIC_KEY = "MQTT";
+    static constexpr const char *STATIC_DEPENDENCIES[] = {"NET", nullptr};
+
     virtual bool isConnected()
     {
-        return this->mqtt->connected();
+        return this->mqtt != nullptr && this->mqtt->connected();
     }
 
     virtual bool reconnect()
@@ -119,18 +130,34 @@ public:
     // publishes a new message on a given topic with a given payload
     virtual void publishRaw(const char *topic, const char *payload, bool retained) override
     {
-        if (this->network->getClient() == nullptr)
+        // PubSubClient is not thread-safe, so the messages from the executor
+        // are copied and published by the main loop
+        if (Mokosh::getInstance()->isInExecutor())
         {
-            mlogE("Cannot publish, Client was not constructed!");
+            String topicCopy(topic);
+            String payloadCopy(payload);
+            if (!Mokosh::getInstance()->post([this, topicCopy, payloadCopy, retained]()
+                                             { this->publishRaw(topicCopy.c_str(), payloadCopy.c_str(), retained); }))
+                mlogE("Cannot publish, executor queue is full");
+
             return;
         }
 
+        MOKOSH_PROFILE_SCOPE("publishRaw");
+
+        // the service may be not set up yet, as tickers start before
         if (this->mqtt == nullptr)
         {
             mlogE("Cannot publish, MQTT Client was not constructed!");
             return;
         }
 
+        if (this->network->getClient() == nullptr)
+        {
+            mlogE("Cannot publish, Client was not constructed!");
+            return;
+        }
+
         if (!this->isMqttConfigured)
         {
             mlogE("Cannot publish, broker address is not configured");
@@ -166,8 +193,10 @@ public:
     // subscribes to a given topic
     virtual void subscribe(const char *topic) override
     {
+        // before connecting, it is subscribed on connection
         subscriptions.push_back(topic);
-        this->mqtt->subscribe(topic);
+        if (this->isConnected())
+            this->mqtt->subscribe(topic);
     }
 
     // unsubscribes from a given topic
@@ -177,7 +206,8 @@ public:
         if (it != subscriptions.end())
         {
             subscriptions.erase(it);
-            this->mqtt->unsubscribe(topic);
+            if (this->isConnected())
+                this->mqtt->unsubscribe(topic);
         }
     }
 
@@ -187,24 +217,22 @@ public:
     {
         auto mokosh = Mokosh::getInstance();
 
-        if (length > 64)
+        if (strcmp(topic, this->cmd_topic.c_str()) == 0)
         {
-            mlogE("MQTT message too long, ignoring.");
-            return;
-        }
+            // the client reuses its buffer when anything is published, also
+            // by logging, so the command is copied before anything is logged
+            if (length >= MOKOSH_COMMAND_SIZE)
+            {
+                mlogE("MQTT command too long, ignoring.");
+                return;
+            }
 
-        char msg[64] = {0};
-        for (unsigned int i = 0; i < length; i++)
-        {
-            msg[i] = message[i];
-        }
-        msg[length + 1] = 0;
+            char command[MOKOSH_COMMAND_SIZE];
+            memcpy(command, message, length);
+            command[length] = 0;
 
-        if (String(topic) == cmd_topic)
-        {
-            mlogD("MQTT command: %s", msg);
-            String command = String(msg);
-            mokosh->_processCommand(command);
+            mlogD("MQTT command: %s", command);
+            mokosh->_processCommand(command, length);
         }
         else
         {
@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""Decoder for the binary log records produced by Mokosh's BinaryLogger.
+
+Usage:
+    mokosh_logdecode.py scan [-o tokens.json] <source dirs or files...>
+        finds format strings of all mlog macros and writes the ID table
+
+    mokosh_logdecode.py decode <tokens.json> [input]
+        decodes records from the input file (or stdin, e.g. piped from
+        a serial port) into text lines
+
+    mokosh_logdecode.py resolve <source dirs or files...> < log.txt
+        replaces file IDs (#xxxxxxxx, when built with MOKOSH_LOG_FILE_IDS)
+        in text logs with the names of the source files
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+LEVELS = {0: "P", 1: "D", 2: "V", 3: "I", 4: "W", 5: "E"}
+SOURCE_EXTENSIONS = (".c", ".cpp", ".h", ".hpp", ".ino")
+
+MLOG_RE = re.compile(r'\bmlog[DVIWE]\s*\(\s*((?:"(?:[^"\\]|\\.)*"\s*)+)')
+LITERAL_RE = re.compile(r'"((?:[^"\\]|\\.)*)"')
+FILE_ID_RE = re.compile(r"#([0-9a-f]{8})\b")
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|z)?([diuxXocpfFeEgGs%])")
+
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\", '"': '"', "'": "'"}
+
+
+def unescape(literal):
+    result = []
+    i = 0
+    while i < len(literal):
+        c = literal[i]
+        if c == "\\" and i + 1 < len(literal):
+            n = literal[i + 1]
+            if n == "x":
+                m = re.match(r"[0-9a-fA-F]+", literal[i + 2:])
+                result.append(chr(int(m.group(0), 16)))
+                i += 2 + len(m.group(0))
+                continue
+            result.append(ESCAPES.get(n, n))
+            i += 2
+            continue
+        result.append(c)
+        i += 1
+    return "".join(result)
+
+
+def format_id(fmt):
+    value = 2166136261
+    for b in fmt.encode("utf-8"):
+        value ^= b
+        value = (value * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def source_files(paths):
+    for path in paths:
+        if os.path.isfile(path):
+            yield path
+            continue
+        for root, _, files in os.walk(path):
+            for name in files:
+                if name.endswith(SOURCE_EXTENSIONS):
+                    yield os.path.join(root, name)
+
+
+def scan(args):
+    tokens = {}
+    for path in source_files(args.paths):
+        with open(path, encoding="utf-8", errors="replace") as f:
+            text = f.read()
+        for match in MLOG_RE.finditer(text):
+            fmt = unescape("".join(LITERAL_RE.findall(match.group(1))))
+            line = text.count("\n", 0, match.start()) + 1
+            key = "%08x" % format_id(fmt)
+            entry = tokens.setdefault(key, {"fmt": fmt, "sites": []})
+            entry["sites"].append("%s:%d" % (os.path.basename(path), line))
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    json.dump(tokens, out, indent=2, sort_keys=True)
+    out.write("\n")
+    if args.output:
+        out.close()
+        print("%d format strings written to %s" % (len(tokens), args.output), file=sys.stderr)
+
+
+def render(fmt, payload):
+    pos = 0
+    out = []
+    last = 0
+    for spec in SPEC_RE.finditer(fmt):
+        out.append(fmt[last:spec.start()])
+        last = spec.end()
+        flags, width, precision, length, conv = spec.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+
+        if width == "*":
+            width = str(struct.unpack_from("<i", payload, pos)[0])
+            pos += 4
+        if precision == "*":
+            precision = str(struct.unpack_from("<i", payload, pos)[0])
+            pos += 4
+
+        pyspec = "%" + (flags or "") + (width or "") + ("." + precision if precision is not None else "")
+        if conv in "diuxXoc":
+            if length == "ll":
+                value = struct.unpack_from("<q" if conv in "di" else "<Q", payload, pos)[0]
+                pos += 8
+            else:
+                value = struct.unpack_from("<i" if conv in "di" else "<I", payload, pos)[0]
+                pos += 4
+            out.append((pyspec + ("d" if conv == "u" else conv)) % value)
+        elif conv == "p":
+            out.append("0x%08x" % struct.unpack_from("<I", payload, pos)[0])
+            pos += 4
+        elif conv in "fFeEgG":
+            out.append((pyspec + conv) % struct.unpack_from("<d", payload, pos)[0])
+            pos += 8
+        elif conv == "s":
+            size = payload[pos]
+            out.append((pyspec + "s") % payload[pos + 1:pos + 1 + size].decode("utf-8", "replace"))
+            pos += 1 + size
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def records(stream):
+    data = stream.read()
+    i = 0
+    while i + 2 <= len(data):
+        if data[i] != SYNC:
+            i += 1
+            continue
+        size = data[i + 1]
+        if size < 11 or i + 2 + size > len(data):
+            i += 1
+            continue
+        yield data[i + 2:i + 2 + size]
+        i += 2 + size
+
+
+def decode(args):
+    with open(args.tokens) as f:
+        tokens = {int(k, 16): v for k, v in json.load(f).items()}
+
+    stream = open(args.input, "rb") if args.input else sys.stdin.buffer
+    for record in records(stream):
+        level, time, fid, line = struct.unpack_from("<BIIH", record, 0)
+        token = tokens.get(fid)
+        if token is None:
+            print("(%s t:%dms) (line %d) <unknown format %08x>" % (LEVELS.get(level, "A"), time, line, fid))
+            continue
+
+        sites = [s for s in token["sites"] if s.endswith(":%d" % line)] or token["sites"]
+        try:
+            msg = render(token["fmt"], record[11:])
+        except (struct.error, IndexError):
+            msg = token["fmt"] + " <truncated>"
+        print("(%s t:%dms) (%s) %s" % (LEVELS.get(level, "A"), time, sites[0], msg))
+
+
+def resolve(args):
+    names = {}
+    for path in source_files(args.paths):
+        name = os.path.basename(path)
+        names[format_id(name)] = name
+
+    def replace(match):
+        return names.get(int(match.group(1), 16), match.group(0))
+
+    for line in sys.stdin:
+        sys.stdout.write(FILE_ID_RE.sub(replace, line))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    scan_parser = commands.add_parser("scan", help="build the format string ID table from sources")
+    scan_parser.add_argument("-o", "--output", help="output JSON file, stdout by default")
+    scan_parser.add_argument("paths", nargs="+")
+    scan_parser.set_defaults(func=scan)
+
+    decode_parser = commands.add_parser("decode", help="decode binary log records")
+    decode_parser.add_argument("tokens", help="ID table produced by scan")
+    decode_parser.add_argument("input", nargs="?", help="binary log, stdin by default")
+    decode_parser.set_defaults(func=decode)
+
+    resolve_parser = commands.add_parser("resolve", help="replace file IDs in text logs with file names")
+    resolve_parser.add_argument("paths", nargs="+")
+    resolve_parser.set_defaults(func=resolve)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()